@@ -0,0 +1,43 @@
+#ifndef AMBIENT_H
+#define AMBIENT_H
+
+#include <Arduino.h>
+
+/*
+ * Ambient light
+ *
+ * Build with -DAMBIENT_LIGHT to dim the display as the room gets dark. A photoresistor divider
+ * on AMBIENT_PIN (photoresistor to 5V, 10k to ground, so more light reads higher) is converted
+ * by the ADC on its own, started by every Timer0 overflow. Its interrupt sums AMBIENT_SAMPLES
+ * conversions into one reading, about 15 a second, and loop() never waits on analogRead().
+ *
+ * Each reading moves an integer exponential moving average 1/2^AMBIENT_SHIFT of the way, a time
+ * constant of about a second, so a passing shadow or mains flicker doesn't reach the display.
+ * ambientBrightness() maps the average linearly onto a brightness between a floor and a
+ * ceiling, and only follows it once it has moved AMBIENT_HYSTERESIS levels (or reached either
+ * end), so a light level on a boundary doesn't make the display hunt. The brightness it
+ * followed to is only moved by ambientUpdate(), once a pass, so asking doesn't change it.
+ *
+ * The filter is shared; the conversions are the platform part (the AVR's ADC interrupt here,
+ * only built in with AMBIENT_LIGHT, and sim/sim_ambient.cpp on the host).
+ */
+
+#define AMBIENT_PIN 1          // analog input A1
+#define AMBIENT_SAMPLES 64     // conversions per reading
+#define AMBIENT_SHIFT 4        // the average moves 1/16 of the way per reading
+#define AMBIENT_DARK 40        // average (0-1023) at or below which the display is at its floor
+#define AMBIENT_BRIGHT 700     // and at or above which it's at its ceiling
+#define AMBIENT_HYSTERESIS 8   // brightness levels
+#define AMBIENT_RAMP 30        // ms per brightness level when the display follows a change
+
+extern volatile uint16_t ambientReadings;   // readings taken, wrapping
+
+uint16_t ambientLevel(void);                            // Filtered light, 0-1023
+byte     ambientBrightness(byte floor, byte ceiling);   // Brightness for it, with hysteresis
+void     ambientUpdate(byte floor, byte ceiling);       // Follow to that brightness
+
+// Platform part
+void ambientStart(void);            // Convert AMBIENT_PIN continuously, calling ambientSample()
+void ambientSample(uint16_t sum);   // From the interrupt: AMBIENT_SAMPLES conversions added up
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef BCD_H
+#define BCD_H
+
+#include <Arduino.h>
+
+/*
+ * Packed BCD helpers
+ *
+ * The clock keeps its time as packed BCD, the DS3231's own register format: the tens digit in
+ * the high nibble, the ones digit in the low one (0x59 is 59). Digits come out with a shift or a
+ * mask, and counting is done digit by digit, so nothing on the display path needs the AVR's
+ * software division.
+ */
+
+constexpr byte bcdTens(byte value) { return value >> 4; }
+constexpr byte bcdOnes(byte value) { return value & 0x0F; }
+
+// Only for printing and arithmetic off the display path (a multiply, no division)
+constexpr byte bcdToBin(byte value) { return bcdTens(value) * 10 + bcdOnes(value); }
+
+// Two ASCII digits, e.g. from __TIME__
+constexpr byte bcdFromChars(char tens, char ones) { return ((tens - '0') << 4) | (ones - '0'); }
+
+// Next value, wrapping from 'max' (BCD) back to 0
+inline byte bcdIncrement(byte value, byte max) {
+  if (value >= max) { return 0; }
+  value++;
+  if (bcdOnes(value) == 0x0A) { value += 0x06; }   // carry into the tens digit
+  return value;
+}
+
+// Previous value, wrapping from 0 to 'max' (BCD)
+inline byte bcdDecrement(byte value, byte max) {
+  if (value == 0) { return max; }
+  if (bcdOnes(value) == 0) { value -= 0x06; }   // borrow from the tens digit
+  return value - 1;
+}
+
+// Step only the ones digit, wrapping 9 <-> 0 without touching the tens
+inline byte bcdOnesUp(byte value) { return bcdOnes(value) == 9 ? value & 0xF0 : value + 1; }
+inline byte bcdOnesDown(byte value) { return bcdOnes(value) == 0 ? value | 0x09 : value - 1; }
+
+// 24-hour BCD hour (0x00-0x23) to 12-hour (0x01-0x12)
+inline byte bcdHour12(byte hour) {
+  if (hour == 0) { return 0x12; }
+  if (hour <= 0x12) { return hour; }
+
+  hour -= 0x12;
+  if (bcdOnes(hour) > 9) { hour -= 0x06; }   // borrow from the tens digit
+  return hour;
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef BUTTONS_H
+#define BUTTONS_H
+
+#include <Arduino.h>
+
+/*
+ * Interrupt-sampled buttons
+ *
+ * A timer interrupt samples all buttons every BUTTON_SAMPLE_US and debounces them together with
+ * two-bit vertical counters: a button's debounced state only flips after BUTTON_DEBOUNCE_SAMPLES
+ * samples in a row disagree with it. Clicks are counted from the debounced edges with the rules
+ * the clock always had from ClickButton:
+ *
+ *   - presses less than BUTTON_MULTI_CLICK apart add up to one event with their count
+ *   - that event comes once the button has stayed released for BUTTON_MULTI_CLICK
+ *   - a press held for BUTTON_LONG_CLICK is a long click, with the count negated, as soon as
+ *     the time is up; releasing it adds nothing
+ *
+ * Events go into a small queue, timestamped with millis(), and wake loop() from its sleep.
+ * buttonsPoll() takes this pass's events into buttonClicks[], at most one per button; a second
+ * one for the same button waits for the next pass. When the queue is full, events are dropped
+ * and counted in buttonsDropped.
+ *
+ * The counting is shared; the sampling is the platform part (the AVR's Timer0 compare interrupt
+ * here, sim/sim_buttons.cpp on the host).
+ */
+
+#define BUTTON_SAMPLE_US 8192       // 8 Timer0 overflows
+#define BUTTON_DEBOUNCE_SAMPLES 4   // what two-bit vertical counters count to (about 30 ms)
+#define BUTTON_MULTI_CLICK 50       // ms
+#define BUTTON_LONG_CLICK 1000      // ms
+#define BUTTON_QUEUE_SIZE 8         // events; a power of two
+
+enum Button
+{
+  BUTTON_SET,
+  BUTTON_UP,
+  BUTTON_DOWN,
+  BUTTONS
+};
+
+extern int8_t        buttonClicks[BUTTONS];      // this pass: clicks, -clicks if long, 0 if none
+extern unsigned long buttonClickTime[BUTTONS];   // millis() when the interrupt saw them
+extern byte          buttonsDropped;             // events lost to a full queue
+
+void buttonsBegin(const byte pins[BUTTONS]);   // Pull up the (active-low) pins, start sampling
+void buttonsPoll(void);                        // Take this pass's events into buttonClicks[]
+bool buttonsPending(void);                     // Are events waiting for the next buttonsPoll()
+
+// Platform part
+void buttonsStart(const byte pins[BUTTONS]);   // Call buttonsSample() every BUTTON_SAMPLE_US
+void buttonsSample(byte pressed);              // From the interrupt: bit b set if button b is down
+
+#endif
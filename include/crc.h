@@ -0,0 +1,24 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <Arduino.h>
+
+/*
+ * CRC-8/CCITT (polynomial x^8 + x^2 + x + 1, initial value 0, as avr-libc's
+ * _crc8_ccitt_update()), computed a nibble at a time from a 16-entry PROGMEM table so a byte
+ * costs two lookups instead of eight shift-and-test steps.
+ */
+
+byte crc8Update(byte crc, byte data);       // Add one byte to a running CRC
+byte crc8(const byte *data, byte length);   // CRC of a whole buffer
+
+/*
+ * CRC-16/CCITT-FALSE (polynomial x^16 + x^12 + x^5 + 1, initial value 0xFFFF, as
+ * avr-libc's _crc_xmodem_update() but started from 0xFFFF), from the same kind of table
+ */
+
+#define CRC16_INIT 0xFFFF
+
+uint16_t crc16Update(uint16_t crc, byte data);   // Add one byte to a running CRC
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef DRIFT_H
+#define DRIFT_H
+
+#include <Arduino.h>
+
+/*
+ * Clock drift tracking
+ *
+ * Between RTC resyncs the clock counts seconds with millis(), and the ATmega's ceramic resonator
+ * can be thousands of ppm off. Each resync is timed at an RTC second edge, so it measures how
+ * many ms the counted time had got ahead of (or behind) the RTC. The rate that implies goes into
+ * a running drift estimate. driftTick() then stretches or shortens the seconds to match, spread
+ * as whole ms over the ticks, so each correction only has to cover what the estimate missed.
+ *
+ * The resync period adapts too: it doubles while the corrections stay within DRIFT_STEADY and
+ * halves when one exceeds DRIFT_UNSTEADY, between DRIFT_MIN_INTERVAL and DRIFT_MAX_INTERVAL.
+ */
+
+#define DRIFT_MIN_INTERVAL 60000UL       // ms
+#define DRIFT_MAX_INTERVAL 3840000UL     // ms (64 minutes)
+#define DRIFT_START_INTERVAL 120000UL    // ms, before there's anything to go by
+#define DRIFT_STEADY 20                  // ms
+#define DRIFT_UNSTEADY 100               // ms
+#define DRIFT_MAX_PPM 20000              // the most the estimate will believe (2%)
+
+extern long          driftPpm;           // us millis() gains per second, estimated
+extern long          driftLastOffset;    // ms the clock was ahead of the RTC at the last resync
+extern long          driftWorstOffset;   // the largest of those, either way
+extern unsigned long driftInterval;      // ms between resyncs
+extern unsigned int  driftResyncs;       // resyncs measured
+
+unsigned int driftTick(void);   // Length of the next second in ms of millis()
+
+// Fold in a resync: the clock was offsetMs ahead of the RTC, elapsedMs after the last one
+void driftMeasured(long offsetMs, unsigned long elapsedMs);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef DS3231_H
+#define DS3231_H
+
+#include <Arduino.h>
+
+/*
+ * DS3231 real-time clock, on the interrupt-driven TWI master (see twi.h)
+ *
+ * Only the time registers are used, in their native packed BCD (see bcd.h); the clock isn't
+ * date-aware. The chip is assumed to run in 24-hour mode, which is what the writes set.
+ */
+
+#define DS3231_ADDRESS 0x68
+#define DS3231_I2C_CLOCK 400000   // Hz; the DS3231 supports fast mode
+
+struct BcdTime {
+  byte hour;     // 0x00-0x23
+  byte minute;   // 0x00-0x59
+  byte second;   // 0x00-0x59
+};
+
+/*
+ * Blocking access, for setup()
+ *
+ * These wait for the bus, so they mustn't be mixed with the background transfers below.
+ */
+
+bool ds3231Begin(void);                      // Start the bus; false if the RTC doesn't answer
+bool ds3231LostPower(void);                  // Has the oscillator stopped since the last set?
+void ds3231ReadTime(BcdTime &time);          // Fetch the current time
+void ds3231WriteTime(const BcdTime &time);   // Set the time and clear the lost-power flag
+
+/*
+ * Background transfers, for loop()
+ *
+ * A request only starts the transaction; the TWI interrupt runs it while loop() carries on, and
+ * ds3231Update(), called every pass, starts the next one when the bus is free. A read queued
+ * behind a write sees the new time, and a write discards any read result not yet collected.
+ */
+
+void ds3231Update(void);                     // Finish and start background transfers
+bool ds3231RequestTime(void);                // Start reading the time; false if one is pending
+bool ds3231TimeReady(BcdTime &time);         // Collect the time requested, once it has arrived
+void ds3231QueueTime(const BcdTime &time);   // Set the time (registers only) in the background
+
+/*
+ * 1 Hz ticks
+ *
+ * ds3231StartTicks() switches the SQW/INT output to a 1 Hz square wave and counts its falling
+ * edges, which is when the seconds register advances, with an external interrupt on 'pin'
+ * (2 or 3 on an ATmega328P; SQW is open drain, so the pin's pull-up is turned on). The main loop
+ * collects them with ds3231TakeTicks(), which holds them back while a time write is queued.
+ */
+
+void ds3231StartTicks(byte pin);   // Enable the 1 Hz output and start counting it
+byte ds3231TakeTicks(void);        // Seconds counted since the last call
+
+#endif
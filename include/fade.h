@@ -0,0 +1,52 @@
+#ifndef FADE_H
+#define FADE_H
+
+#include <Adafruit_NeoPixel.h>
+#include <Arduino.h>
+
+/*
+ * Crossfades between clock frames
+ *
+ * Build with -DCROSSFADE to have the clock fade each pixel from the old pattern to the new one
+ * over FADE_STEPS steps, FADE_STEP_MS apart, instead of switching in a single show(). Each step
+ * blends the two frames' bytes in 8.8 fixed point with that step's weight, from a PROGMEM table
+ * generated at compile time from a smoothstep curve; the last weight is exactly 1.0, so the
+ * fade always ends on the new frame.
+ *
+ * A fade is time-sliced work in loop(): fadeTick() shows at most the one step that's due each
+ * pass and reports the next with schedAt(). A step is held back while button events wait to be
+ * taken, or when its cost (the slowest step so far, show() included) would run past the
+ * earliest deadline reported this pass (schedNext()) - the second tick, an RTC resync, a blink.
+ * Steps whose time has passed are dropped, not queued up, so the fade ends on time; the final
+ * frame is forced once a full step late. Anything else drawing to the strip (frameRender(),
+ * frameClear()) stops a running fade.
+ *
+ * 'f' over serial prints the fades' statistics. Without the flag the macros below expand to
+ * nothing.
+ */
+
+#define FADE_STEPS 16     // blended frames per fade, the last being the new frame
+#define FADE_STEP_MS 25   // ms between them: 40 per second, 400 ms a fade
+
+#ifdef CROSSFADE
+
+extern uint16_t fadesStarted;       // fades begun
+extern uint32_t fadeStepsShown;     // steps shown
+extern uint32_t fadeStepsDropped;   // steps skipped because they came due while held back
+extern uint32_t fadeStepsHeld;      // passes a due step was held back
+extern uint16_t fadeStepUs;         // cost of the slowest step, show() included
+
+#define FADE_STOP() fadeStop()
+
+bool     fadeShow(Adafruit_NeoPixel &strip);   // Fade to the strip's buffer; false if unchanged
+void     fadeTick(Adafruit_NeoPixel &strip);   // Show the step that's due, if the budget allows
+void     fadeStop(void);                       // Abandon a running fade where it is
+uint16_t fadeFps(void);                        // Steps shown per second of fading
+
+#else
+
+#define FADE_STOP()
+
+#endif
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <Adafruit_NeoPixel.h>
+#include <Arduino.h>
+
+#include "layout.h"
+
+/*
+ * Frames
+ *
+ * A frame's lit pixels are one FrameBits mask in digit-group order: group g owns groupSize(g)
+ * bits starting at bit groupFirstBit(g), and bit i of a group is groupPixel(g, i). Each group
+ * has its own color for lit and for unlit pixels (menus use a dim white background and blank
+ * blinking digits), as entries of the palette cache (palette.h). The mask is 32 bits unless the
+ * layout has more pixels than that.
+ */
+
+template <bool Wide>
+struct FrameBitsFor {
+  typedef uint32_t type;
+};
+template <>
+struct FrameBitsFor<true> {
+  typedef uint64_t type;
+};
+typedef FrameBitsFor<(LAYOUT_PIXELS > 32)>::type FrameBits;
+
+static_assert(LAYOUT_PIXELS <= 64, "frame masks are at most 64 bits");
+
+constexpr byte groupFirstBit(byte group) { return groupFirstCol(group) * LAYOUT_ROWS; }
+
+// Frame bit for a strip pixel
+constexpr byte pixelBit(byte pixel) {
+  return groupFirstBit(pixelGroup(pixel)) + (pixel / LAYOUT_COLS) * groupCols(pixelGroup(pixel)) +
+         pixelColumn(pixel) - groupFirstCol(pixelGroup(pixel));
+}
+constexpr FrameBits pixelMask(byte pixel) { return (FrameBits)1 << pixelBit(pixel); }
+
+// Frame bits of a pattern over a group's pixels (bit i = groupPixel(group, i))
+constexpr FrameBits groupBits(byte group, uint16_t pattern) {
+  return (FrameBits)pattern << groupFirstBit(group);
+}
+
+struct Frame {
+  FrameBits lit;                   // lit pixels, in digit-group bit order
+  byte      color[DIGIT_GROUPS];   // palette color of lit pixels
+  byte      unlit[DIGIT_GROUPS];   // palette color of unlit pixels
+};
+
+// Lit mask of the frame last written by frameRender()
+extern FrameBits frameLit;
+
+// The digit a group shows of a BCD time { hour as displayed, minute, second }
+byte frameTimeDigit(byte group, const byte time[3]);
+
+// Frame bits lighting the first 'digit' pixels of a group (unrandomized, for menus)
+FrameBits frameDigit(byte group, byte digit);
+
+// Frame bits lighting all of a group's pixels
+FrameBits frameGroup(byte group);
+
+// Frame bits lighting 'digit' random pixels of a group, changing at least one pixel from
+// frameLit when possible
+FrameBits frameRandomDigit(byte group, byte digit);
+
+// Write a whole frame into a NeoPixel buffer (LAYOUT_COLOR_ORDER, 3 bytes per pixel) from the
+// palette cache, which already holds the colors at the current brightness, and hold it to the
+// current budget (power.h)
+void frameRender(const Frame &frame, byte *pixels);
+
+// Write the last frame again, after the palette cache was rebuilt (brightness or scheme change)
+void frameRefresh(byte *pixels);
+
+// Turn off all pixels, and forget the last frame so the next random digits may light any pixel
+void frameClear(byte *pixels);
+
+/*
+ * Showing
+ *
+ * strip.show() keeps interrupts off for about 30 us per pixel, which costs millis() ticks and
+ * button samples. frameShow() keeps a shadow copy of the last buffer pushed to the strip and
+ * only calls show() when it differs, so redrawing an unchanged frame is just a compare of the
+ * buffer. (The strip's own brightness is never set; the palette cache does the scaling.)
+ */
+
+extern uint32_t frameShowsIssued;    // show() calls made by frameShow()
+extern uint32_t frameShowsSkipped;   // frameShow() calls where nothing had changed
+
+// Push the strip's buffer to the LEDs if it changed since the last frameShow(); true if shown
+bool frameShow(Adafruit_NeoPixel &strip);
+
+// The pixels last pushed to the LEDs (all off before the first show)
+const byte *frameShownPixels(void);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <Arduino.h>
+
+/*
+ * Latency histograms with log2 buckets
+ *
+ * Bucket 0 holds values under 8 us, bucket i (1-14) holds [2^(i+2), 2^(i+3)) us and bucket 15
+ * everything from 131 ms up. Counts are 16 bits; when one would overflow, all buckets are
+ * halved (rounding up) so the shape, and the p99 derived from it, keeps tracking recent
+ * behaviour without losing the rare slow values. Used by the loop() profiler and the latency
+ * tracer; only linked in when one of them is built.
+ */
+
+#define HISTOGRAM_BUCKETS 16
+
+struct Histogram {
+  unsigned long count;
+  unsigned long min;
+  unsigned long max;
+  uint16_t      buckets[HISTOGRAM_BUCKETS];
+};
+
+void histogramRecord(Histogram &h, unsigned long us);   // Add one value
+void histogramPrint(const Histogram &h);   // ", count, min, max, p99, buckets" to Serial
+
+#endif
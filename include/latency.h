@@ -0,0 +1,46 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <Arduino.h>
+
+/*
+ * Button-to-photon latency tracing
+ *
+ * Build with -DLATENCY_TRACE to time each button event from the pin edge that produced it to
+ * the strip.show() that displays the reaction to it, in stages:
+ *
+ *   debounce   the raw edge (the first sample that saw it) to the sample that accepted it
+ *   click      acceptance to loop() taking the event: the click rules' wait (BUTTON_MULTI_CLICK
+ *              after a release, the rest of BUTTON_LONG_CLICK into a hold) plus the wake-up
+ *   render     the event taken to the end of the first strip.show() after it, in the same pass
+ *   total      the raw edge to the end of that show()
+ *
+ * A click's edge is its release; a long click's, the press. An event whose pass shows nothing
+ * (its press changed nothing on the display) isn't timed, only counted. Each stage keeps a
+ * histogram (see histogram.h); 't' over serial dumps them and 'T' resets them. Without the flag
+ * the macros below expand to nothing.
+ */
+
+#define LATENCY_STAGES 4
+
+#ifdef LATENCY_TRACE
+
+#define LATENCY_HANDLED(edgeUs, acceptedUs) latencyHandled(edgeUs, acceptedUs)
+#define LATENCY_SHOWN() latencyShown()
+#define LATENCY_PASS_END() latencyPassEnd()
+
+void latencyHandled(unsigned long edgeUs, unsigned long acceptedUs);   // loop() took an event
+void latencyShown(void);     // strip.show() just finished
+void latencyPassEnd(void);   // End of the loop() pass: drop an event nothing was shown for
+void latencyDump(void);      // Print all histograms to serial
+void latencyReset(void);     // Clear all histograms
+
+#else
+
+#define LATENCY_HANDLED(edgeUs, acceptedUs)
+#define LATENCY_SHOWN()
+#define LATENCY_PASS_END()
+
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <Arduino.h>
+
+/*
+ * Display layout
+ *
+ * The LEDs are laid out to be compatible with using sections of LED strip:
+ *
+ * HourTens             HourOnes              MinuteTens             MinuteOnes
+ *     0      ---     1 --  2 --  3    ---      4 --  5    ---     6 --   7 -- 8
+ *                                                                             |
+ *     17     ---    16 -- 15 -- 14    ---     13 -- 12    ---    11 --  10 -- 9
+ *     |
+ *     18     ---    19 -- 20 -- 21    ---     22 -- 23    ---    24 --  25 -- 26
+ *
+ * i.e. LAYOUT_ROWS rows of pixels wired as a serpentine, with each digit group a range of
+ * columns, left to right. layoutGroups[] is the whole description of a panel: each group's
+ * width, the time digit it shows and the largest value that digit takes. Everything else (the
+ * panel's width, pixel lists, group sizes, the frame bit order and the renderer's tables, the
+ * clock's and menus' frames, the simulator's printout) is derived from it at compile time.
+ *
+ * Variants are build flags:
+ *   LAYOUT_24H       hours 00-23 instead of 1-12 (the hour tens column goes up to 2)
+ *   LAYOUT_SECONDS   seconds tens and ones groups right of the minutes, 5 more columns
+ * Another panel only needs its own groups here.
+ */
+
+#define LAYOUT_ROWS 3
+
+// Pixel color order on the wire (Adafruit_NeoPixel type flags)
+#define LAYOUT_COLOR_ORDER NEO_RGB
+
+#ifdef LAYOUT_24H
+#define LAYOUT_HOURS 24
+#else
+#define LAYOUT_HOURS 12
+#endif
+
+enum DigitGroup
+{
+  HOUR_TENS,
+  HOUR_ONES,
+  MINUTE_TENS,
+  MINUTE_ONES,
+#ifdef LAYOUT_SECONDS
+  SECOND_TENS,
+  SECOND_ONES,
+#endif
+  DIGIT_GROUPS
+};
+
+// Digits of a BCD time { hour as displayed, minute, second }: field * 2, plus 1 for the ones
+enum TimeDigit
+{
+  DIGIT_HOUR_TENS,
+  DIGIT_HOUR_ONES,
+  DIGIT_MINUTE_TENS,
+  DIGIT_MINUTE_ONES,
+  DIGIT_SECOND_TENS,
+  DIGIT_SECOND_ONES
+};
+
+struct LayoutGroup {
+  byte cols;    // width in columns
+  byte digit;   // TimeDigit shown
+  byte max;     // largest value shown
+  byte color;   // color of the scheme (palette.h) it's drawn in
+};
+
+constexpr LayoutGroup layoutGroups[DIGIT_GROUPS] = {
+  { 1, DIGIT_HOUR_TENS, LAYOUT_HOURS / 10, 0 },
+  { 3, DIGIT_HOUR_ONES, 9, 1 },
+  { 2, DIGIT_MINUTE_TENS, 5, 2 },
+  { 3, DIGIT_MINUTE_ONES, 9, 3 },
+#ifdef LAYOUT_SECONDS
+  { 2, DIGIT_SECOND_TENS, 5, 2 },   // seconds in the minutes' colors
+  { 3, DIGIT_SECOND_ONES, 9, 3 },
+#endif
+};
+
+/*
+ * Derived geometry. These are only meant for constant expressions (tables, static_asserts, fixed
+ * groups); code looking up a group known only at run time uses frame.cpp's PROGMEM tables.
+ */
+
+constexpr byte groupCols(byte group) { return layoutGroups[group].cols; }
+constexpr byte groupDigit(byte group) { return layoutGroups[group].digit; }
+constexpr byte groupMax(byte group) { return layoutGroups[group].max; }
+constexpr byte groupColor(byte group) { return layoutGroups[group].color; }
+
+// First column of a group (of DIGIT_GROUPS: the panel's width)
+constexpr byte groupFirstCol(byte group) {
+  return group == 0 ? 0 : groupFirstCol(group - 1) + groupCols(group - 1);
+}
+
+#define LAYOUT_COLS groupFirstCol(DIGIT_GROUPS)
+#define LAYOUT_PIXELS (LAYOUT_ROWS * LAYOUT_COLS)
+
+// Pixels per group - also the largest digit the group can show
+constexpr byte groupSize(byte group) { return groupCols(group) * LAYOUT_ROWS; }
+
+// Does any group show the seconds (so the clock redraws every second)
+constexpr bool layoutShowsSeconds(byte group = 0) {
+  return group < DIGIT_GROUPS &&
+         (groupDigit(group) >= DIGIT_SECOND_TENS || layoutShowsSeconds(group + 1));
+}
+
+// Strip index of a (row, column) position
+constexpr byte layoutPixel(byte row, byte col) {
+  return row * LAYOUT_COLS + ((row & 1) ? LAYOUT_COLS - 1 - col : col);
+}
+
+// Strip index of the i-th pixel of a group; digits light up in this order (row by row)
+constexpr byte groupPixel(byte group, byte i) {
+  return layoutPixel(i / groupCols(group), groupFirstCol(group) + i % groupCols(group));
+}
+
+// Column and group of a strip pixel
+constexpr byte pixelColumn(byte pixel) {
+  return ((pixel / LAYOUT_COLS) & 1) ? LAYOUT_COLS - 1 - pixel % LAYOUT_COLS : pixel % LAYOUT_COLS;
+}
+constexpr byte columnGroup(byte col, byte group = 0) {
+  return group + 1 < DIGIT_GROUPS && col >= groupFirstCol(group + 1) ? columnGroup(col, group + 1)
+                                                                     : group;
+}
+constexpr byte pixelGroup(byte pixel) { return columnGroup(pixelColumn(pixel)); }
+
+#endif
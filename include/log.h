@@ -0,0 +1,86 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+/*
+ * Serial logger
+ *
+ * Messages are written with logError/logWarn/logInfo/logDebug, which take the same print() and
+ * println() arguments as Serial. The level is fixed at compile time with -DLOG_LEVEL=...; the
+ * loggers above it are empty objects whose calls compile to nothing, arguments included.
+ *
+ * Enabled messages go into a RAM ring buffer instead of the HardwareSerial TX buffer, and
+ * logDrain() (called from loop()) moves them out only as fast as the TX buffer has room, so
+ * logging never blocks. A message is everything up to its println(). If it doesn't fit, the
+ * whole message is dropped and counted in logDropped, rather than waiting or sending half a
+ * line.
+ */
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_BUFFER_SIZE 128   // bytes; a power of two so the ring indices wrap with a mask
+
+class LogBuffer : public Print {
+ public:
+  size_t write(uint8_t c);
+  using Print::write;
+};
+
+extern LogBuffer     logBuffer;
+extern unsigned long logDropped;   // messages dropped because the buffer was full
+
+void logDrain(void);   // Move queued bytes to Serial without blocking
+void logFlush(void);   // Send everything queued, blocking until done
+
+// Queue a block of raw bytes (e.g. a binary frame) as one message, or drop it whole
+bool logWriteRaw(const byte *data, byte length);
+
+template <bool Enabled>
+struct Logger {
+  template <typename T>
+  void print(T value) {
+    logBuffer.print(value);
+  }
+  template <typename T>
+  void print(T value, int format) {
+    logBuffer.print(value, format);
+  }
+  template <typename T>
+  void println(T value) {
+    logBuffer.println(value);
+  }
+  template <typename T>
+  void println(T value, int format) {
+    logBuffer.println(value, format);
+  }
+  void println(void) { logBuffer.println(); }
+};
+
+template <>
+struct Logger<false> {
+  template <typename T>
+  void print(T) {}
+  template <typename T>
+  void print(T, int) {}
+  template <typename T>
+  void println(T) {}
+  template <typename T>
+  void println(T, int) {}
+  void println(void) {}
+};
+
+extern Logger<(LOG_LEVEL >= LOG_LEVEL_ERROR)> logError;
+extern Logger<(LOG_LEVEL >= LOG_LEVEL_WARN)>  logWarn;
+extern Logger<(LOG_LEVEL >= LOG_LEVEL_INFO)>  logInfo;
+extern Logger<(LOG_LEVEL >= LOG_LEVEL_DEBUG)> logDebug;
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef MENU_H
+#define MENU_H
+
+#include <Arduino.h>
+
+/*
+ * Table-driven menu state machine
+ *
+ * Each state is one PROGMEM row, found by indexing the table with the state number:
+ *
+ *   enter    on arriving; a state that only saves something does it here and moves on
+ *   tick     every loop() pass: value buttons and timers. Calls menuRedraw() when the display
+ *            needs redrawing, menuTouch() on user input, menuGo() to move on.
+ *   exit     on leaving
+ *   render   draw the state; only called after menuRedraw(), once per pass
+ *
+ * and where each MenuEvent leads (MENU_STAY to ignore it). Events that move between states
+ * are only ever seen by the table, so a button press can't be handled twice. Any handler may
+ * be NULL.
+ */
+
+#define MENU_STAY 0xFF
+#define MENU_TIMEOUT 20000   // ms without menuTouch() before the timeout event
+
+enum MenuEvent
+{
+  EVENT_SET,         // short press of Set
+  EVENT_SET_LONG,    // long press of Set
+  EVENT_UP_LONG,     // long press of Up
+  EVENT_DOWN_LONG,   // long press of Down
+  EVENT_IDLE,        // no input for MENU_TIMEOUT (raised by menuRun() itself)
+  MENU_EVENTS
+};
+
+#define MENU_EVENT(event) (1 << (event))
+
+typedef void (*MenuHandler)(void);
+
+struct MenuState {
+  MenuHandler enter;
+  MenuHandler tick;
+  MenuHandler exit;
+  MenuHandler render;
+  byte        on[MENU_EVENTS];   // next state for each event
+};
+
+extern byte menuPosition;   // current state
+
+void menuBegin(const MenuState *table, byte state);   // Start in a state: enter and render it
+
+// One pass: tick the current state, apply the events (MENU_EVENT() bits) and any menuGo(), then
+// render if asked to
+void menuRun(const MenuState *table, byte events);
+
+void menuGo(byte state);   // Move to another state at the end of this tick or enter
+void menuRedraw(void);     // Have the current state rendered at the end of this pass
+void menuTouch(void);      // Note user input, restarting the timeout
+
+#endif
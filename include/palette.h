@@ -0,0 +1,44 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <Arduino.h>
+
+#include "frame.h"
+
+/*
+ * Colors
+ *
+ * The color schemes are kept in PROGMEM as plain RGB. paletteBuild() turns the chosen scheme,
+ * the menu whites and off into a small cache of wire-order bytes at the current brightness, so
+ * rendering a pixel is a 3-byte copy. Brightness is applied once per color instead of once per
+ * pixel write, and never to the strip's buffer after the fact: strip.setBrightness() rescales
+ * the buffer in place, losing low bits each time and leaving getPixelColor() to guess at what
+ * was written.
+ *
+ * A brightness setting goes through an 8-bit lookup table to become the PWM scale. The steps
+ * between brightnessMin (50) and brightnessMax (250) are evenly spaced in perceived lightness,
+ * taken as PWM^(1/2.6) as for Adafruit_NeoPixel::gamma8(), with both ends left where they were.
+ * Linear steps double the light from the first level to the second but add only a quarter from
+ * the fourth to the fifth; these go by 1.4-1.7x each.
+ */
+
+#define PALETTE_SCHEMES 7
+#define PALETTE_SCHEME_COLORS 4   // hour tens, hour ones, minute tens, minute ones
+
+// Cache entries. Digit group g is drawn in PALETTE_DIGIT + g, its groupColor() of the scheme.
+enum PaletteColor
+{
+  PALETTE_OFF,
+  PALETTE_DIGIT,
+  PALETTE_DIM_WHITE = PALETTE_DIGIT + DIGIT_GROUPS,   // menu background
+  PALETTE_WHITE,                                      // menu indicators
+  PALETTE_COLORS
+};
+
+extern byte     paletteCache[PALETTE_COLORS][3];   // LAYOUT_COLOR_ORDER, scaled
+extern uint16_t paletteLoad[PALETTE_COLORS];       // each entry's bytes added up (power.h)
+
+byte paletteLevel(byte brightness);                // PWM scale for a brightness setting
+void paletteBuild(byte scheme, byte brightness);   // Fill the cache; scheme < PALETTE_SCHEMES
+
+#endif
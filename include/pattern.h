@@ -0,0 +1,23 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include <Arduino.h>
+
+/*
+ * Random digit patterns with a guaranteed change
+ *
+ * A digit shows `count` lit LEDs out of the `size` LEDs in its group. Patterns are bitmasks
+ * over the group's LEDs (bit i = pixelList[i]). patternNext() draws a new pattern uniformly
+ * from all count-subsets that are not contained in `previous`, i.e. at least one newly lit LED
+ * was dark before - the same distribution the old shuffle-and-retry loop converged to, but with
+ * exactly one random draw (rngBelow(), see rng.h) and O(size) work.
+ *
+ * If no such subset exists (count is 0 or size, or every LED was already lit) any subset is
+ * returned, since no change can be guaranteed.
+ */
+
+#define PATTERN_MAX_LEDS 9   // largest digit group; keeps every binomial below 256
+
+uint16_t patternNext(byte size, byte count, uint16_t previous);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+
+/*
+ * Current limiting
+ *
+ * Each of a WS2812B's three LEDs draws about POWER_MA_PER_CHANNEL at full PWM, in proportion to
+ * its value, and the chip about POWER_IDLE_UA more even when dark. So a frame's draw follows
+ * from the sum of its channel values, which the code writing the frame adds up as it writes
+ * each pixel (frameRender() takes every color's sum from the palette cache, a fade step adds
+ * the bytes it blends): the buffer is never scanned for it. powerLimit() turns that sum into
+ * milliamps when the frame is complete. Over POWER_BUDGET_MA it scales every channel of the
+ * frame down by the same fraction, which keeps the hues, until it fits: at brightnessMax the
+ * color scheme chooser, with every pixel lit, would otherwise draw more than a USB port gives.
+ *
+ * POWER_BUDGET_MA is for the LEDs alone and can be set with a build flag for a bigger supply.
+ */
+
+#ifndef POWER_BUDGET_MA
+#define POWER_BUDGET_MA 450   // what a 500 mA USB port leaves after the board
+#endif
+#define POWER_MA_PER_CHANNEL 20   // mA per LED at full PWM
+#define POWER_IDLE_UA 1000        // uA per pixel with all three LEDs off
+
+extern uint16_t powerMa;         // estimated draw of the last frame, as limited
+extern uint16_t powerDemandMa;   // and what it would have drawn unlimited
+extern uint32_t powerLimited;    // frames scaled down to the budget
+
+uint16_t powerEstimate(uint16_t load);              // mA for a frame's channel values added up
+void     powerLimit(byte *pixels, uint16_t load);   // Estimate a complete frame, scale it to fit
+
+#endif
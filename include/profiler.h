@@ -0,0 +1,34 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+/*
+ * loop() latency profiler
+ *
+ * Build with -DLOOP_PROFILER to time every pass through loop() with micros(). Each menu position
+ * gets a log2-bucket histogram plus min/max (see histogram.h), which is dumped over serial by
+ * the 'p' command. Without the flag the macros below expand to nothing.
+ */
+
+#define PROFILER_STATES 10   // one per menu position
+
+#ifdef LOOP_PROFILER
+
+#define PROFILE_LOOP_BEGIN(state)   \
+  const byte profileState = (state); \
+  const unsigned long profileStart = micros()
+#define PROFILE_LOOP_END() profilerRecord(profileState, micros() - profileStart)
+
+void profilerRecord(byte state, unsigned long us);   // Add one loop() pass to a state's histogram
+void profilerDump(void);                              // Print all histograms to serial
+void profilerReset(void);                             // Clear all histograms
+
+#else
+
+#define PROFILE_LOOP_BEGIN(state)
+#define PROFILE_LOOP_END()
+
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <Arduino.h>
+
+/*
+ * Pattern random numbers
+ *
+ * A 32-bit xorshift generator (Marsaglia's 13/17/5 triple, period 2^32 - 1). A draw is three
+ * shift-and-xor steps, against avr-libc random()'s 32-bit division and the modulo Arduino's
+ * random(max) adds on top. rngBelow() scales the top 24 bits by the bound with one multiply
+ * instead of a modulo; that leaves each value at most bound / 2^24 off uniform, well below
+ * anything a digit pattern could show.
+ *
+ * rngBegin() seeds it from several sources, since one analogRead() of a floating pin reads much
+ * the same on every power-up of a board: the low bits of RNG_ADC_READS reads, the jitter
+ * between the watchdog's own RC oscillator and the CPU clock, and whatever is mixed in later
+ * with rngMix() (the first RTC time read and when it arrived). The watchdog (the platform part)
+ * is sampled in the background, from its interrupt, over the first RNG_JITTER_SAMPLES timeouts
+ * after rngBegin(), and turned off after the last.
+ */
+
+#define RNG_ADC_PIN 0          // left floating
+#define RNG_ADC_READS 16       // reads to take the low bits of
+#define RNG_JITTER_SAMPLES 4   // watchdog timeouts (16 ms each) to sample
+
+void     rngBegin(void);             // Seed from the ADC, and start sampling the watchdog
+void     rngMix(uint32_t entropy);   // Stir more entropy into the state
+void     rngSeed(uint32_t seed);     // Restart from a fixed state, for repeatable sequences
+uint32_t rngNext(void);              // Next raw 32-bit value
+byte     rngBelow(byte bound);       // Uniform in [0, bound); 0 if bound is 0
+
+// Platform part: the AVR's watchdog here, sim/sim_rng.cpp on the host
+void rngWatchdogStart(void);   // Call rngTimeout() at each watchdog timeout until it's false
+bool rngTimeout(void);         // From the interrupt: mix in the timer bits; false when done
+
+// The simulator charges each draw (rngBelow()'s if scaled) to its clock; nothing on the AVR
+#ifdef __AVR__
+#define RNG_DRAWN(scaled)
+#else
+void rngDrawn(bool scaled);
+#define RNG_DRAWN(scaled) rngDrawn(scaled)
+#endif
+
+#endif
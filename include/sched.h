@@ -0,0 +1,37 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <Arduino.h>
+
+/*
+ * Deadline scheduler with idle sleep
+ *
+ * Everything that has to run again at a known time reports it with schedAt() during the loop()
+ * pass: the next second tick, display redraw, menu blink and timeout, RTC resync, settings
+ * commit. schedSleep() at the end of the pass keeps the MCU in SLEEP_MODE_IDLE until the
+ * earliest of them. Timer0's millis() interrupt wakes it every ms to check the deadline and
+ * otherwise it goes straight back to sleep. Interrupts that bring new work end the sleep early:
+ * bytes arriving on Serial, or an ISR calling schedWake() (a button event, the RTC's 1 Hz
+ * tick). Deadlines only last one pass, so anything still waiting reports again next time;
+ * without any, the pass repeats after SCHED_MAX_SLEEP. Work that can wait (a crossfade step)
+ * checks schedNext() so as not to run past one.
+ *
+ * schedDutyCycle is the share of the last SCHED_DUTY_WINDOW (or the first pass after it, if
+ * that came later) that the CPU spent awake, in hundredths of a percent: idle display passes
+ * take well under a millisecond a second.
+ */
+
+#define SCHED_MAX_SLEEP 2000          // ms to sleep when nothing reported a deadline
+#define SCHED_DUTY_WINDOW 1000000UL   // us over which schedDutyCycle is measured
+
+extern unsigned int schedDutyCycle;   // 0.01% units of the last window spent awake
+
+void          schedAt(unsigned long ms);   // Run loop() again no later than millis() == ms
+unsigned long schedNext(void);             // Earliest deadline reported so far this pass
+void          schedWake(void);             // End the current or next sleep (ISR-safe)
+void          schedSleep(void);            // Sleep until the earliest deadline or a wake-up
+
+// Platform part: the AVR's sleep mode here, sim/sim_sched.cpp on the host
+void schedIdle(void);   // Sleep until the next interrupt, unless a wake-up is pending
+
+#endif
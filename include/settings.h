@@ -0,0 +1,28 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <Arduino.h>
+
+/*
+ * User settings, as persisted in the EEPROM store (see store.h)
+ *
+ * Only what the firmware reads back is kept; the digit colors follow from the color scheme.
+ * Changing this struct means a new SETTINGS_VERSION and a migration from the previous one in
+ * settings.cpp, so users keep their settings across firmware updates.
+ */
+
+#define SETTINGS_VERSION 1
+
+struct Settings {
+  uint16_t updateInterval;   // ms between display updates
+  byte     brightness;
+  byte     colorScheme;
+};
+
+extern Settings settings;
+
+bool settingsLoad(void);      // Replace 'settings' with the saved ones; false if none are usable
+void settingsChanged(void);   // 'settings' was modified; save it once it settles
+void settingsFlush(void);     // Save a modification now
+
+#endif
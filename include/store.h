@@ -0,0 +1,46 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include <Arduino.h>
+
+/*
+ * Wear-leveled record store
+ *
+ * The EEPROM is split into fixed-size slots, each holding one record:
+ *
+ *   0-1    sequence number, little-endian (0xFFFF is skipped, so erased slots never count)
+ *   2      payload format version (the caller's to define)
+ *   3      payload length
+ *   4-     payload
+ *   then   CRC-16 of everything before it, little-endian (see crc.h)
+ *
+ * Each commit goes to the slot after the newest record, so wear is spread over the whole
+ * EEPROM, and only the cells whose value differs from what that slot already holds are
+ * programmed. A commit cut short by a power loss leaves a bad CRC behind and the previous
+ * record stays the newest. Slots don't depend on the payload, so a firmware with a different
+ * format still finds the old record and can migrate it.
+ *
+ * The payload lives in the caller's RAM; storeChanged() only notes that it was modified. It's
+ * committed once nothing else has changed for STORE_COMMIT_DELAY, so stepping through a setting
+ * costs one commit at the end, and not at all if it ends up back where it was.
+ */
+
+#define STORE_SLOT_SIZE 16
+#define STORE_PAYLOAD_MAX (STORE_SLOT_SIZE - 6)
+#define STORE_COMMIT_DELAY 5000   // ms a change must stay put before it's written
+
+extern unsigned long storeBytesWritten;   // EEPROM cells programmed
+extern unsigned long storeBlockedUs;      // time spent waiting for them
+
+// Find the newest record and copy up to 'size' bytes of its payload; false if there's none
+bool storeLoad(void *payload, byte size, byte &version, byte &length);
+
+// Payload and version written by commits from now on (call after storeLoad())
+void storeAttach(const void *payload, byte length, byte version);
+
+void storeChanged(void);   // The payload was modified
+void storePoll(void);      // Commit a change once it has settled
+void storeFlush(void);     // Commit a change now
+int  storeSlot(void);      // Slot of the newest record, -1 if none
+
+#endif
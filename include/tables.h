@@ -0,0 +1,24 @@
+#ifndef TABLES_H
+#define TABLES_H
+
+#include <Arduino.h>
+
+/*
+ * Compile-time tables
+ *
+ * MakeIndexSeq<N>::type is IndexSeq<0, 1, ..., N - 1>. A template specialized on it can expand
+ * a constexpr function over every index, so a PROGMEM table is generated from its formula
+ * instead of being written out (the layout tables in frame.cpp and palette.cpp, the fade weights
+ * in fade.cpp).
+ */
+
+template <byte... Is>
+struct IndexSeq {};
+template <byte N, byte... Is>
+struct MakeIndexSeq : MakeIndexSeq<N - 1, N - 1, Is...> {};
+template <byte... Is>
+struct MakeIndexSeq<0, Is...> {
+  typedef IndexSeq<Is...> type;
+};
+
+#endif
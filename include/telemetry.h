@@ -0,0 +1,66 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+
+/*
+ * Binary telemetry
+ *
+ * Build with -DTELEMETRY to send one fixed-size frame per second over serial, queued through
+ * the log buffer so it never blocks loop(). Text log messages can stay on: the sync byte is
+ * never printable ASCII, and the decoder (sim/telemetry_decode) only accepts a frame whose CRC
+ * checks out. Without the flag the macros below expand to nothing.
+ *
+ * Frame layout, multi-byte fields little-endian, counts since the previous frame:
+ *
+ *   0      sync (TELEMETRY_SYNC)
+ *   1      sequence number, wraps at 256 (gaps mean dropped frames)
+ *   2-5    loop() passes
+ *   6-8    hour, minute, second (packed BCD, as kept by the clock)
+ *   9-10   seconds the RTC resync moved the clock by (signed, the last one if several)
+ *   11     RTC resyncs
+ *   12-13  strip.show() calls issued
+ *   14     EEPROM writes
+ *   15-17  click events on the set, up and down buttons
+ *   18-19  estimated LED current of the last frame, mA, as limited (see power.h)
+ *   20-21  and unlimited
+ *   22     frames scaled down to the current budget (saturating)
+ *   23     CRC-8 of bytes 0-22 (see crc.h)
+ */
+
+#define TELEMETRY_SYNC 0xA5
+#define TELEMETRY_FRAME_SIZE 24
+#define TELEMETRY_INTERVAL 1000   // ms between frames
+
+#ifdef TELEMETRY
+
+struct TelemetryCounters {
+  unsigned long loops;
+  int           rtcDelta;
+  byte          resyncs;
+  byte          eepromWrites;
+  byte          clicks[3];   // set, up, down
+};
+
+extern TelemetryCounters telemetry;
+
+#define TELEMETRY_COUNT(counter) telemetry.counter++
+#define TELEMETRY_BUTTONS(set, up, down) telemetryButtons(set, up, down)
+#define TELEMETRY_RESYNC(oldH, oldM, oldS, newH, newM, newS) \
+  telemetryResync(oldH, oldM, oldS, newH, newM, newS)
+#define TELEMETRY_POLL(h, m, s) telemetryPoll(h, m, s)
+
+void telemetryButtons(int set, int up, int down);        // Count this pass's click events
+void telemetryResync(byte, byte, byte, byte, byte, byte);   // Note an RTC resync's jump (BCD)
+void telemetryPoll(byte hour, byte minute, byte second);    // Queue a frame when one is due
+
+#else
+
+#define TELEMETRY_COUNT(counter)
+#define TELEMETRY_BUTTONS(set, up, down)
+#define TELEMETRY_RESYNC(oldH, oldM, oldS, newH, newM, newS)
+#define TELEMETRY_POLL(h, m, s)
+
+#endif
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef TWI_H
+#define TWI_H
+
+#include <Arduino.h>
+
+/*
+ * Interrupt-driven I2C (TWI) master
+ *
+ * twiStart() queues one transaction - an optional write, then an optional read after a
+ * repeated start - and returns at once; the TWI interrupt clocks the bytes out and in, and
+ * twiStatus() reports when it has finished. The tx and rx buffers must stay valid until then.
+ *
+ * This replaces Wire, which blocks loop() for the whole transfer (and owns the same interrupt
+ * vector, so the two can't be linked together). On the AVR it drives the TWI registers
+ * directly; the host simulator supplies its own implementation (sim/sim_twi.cpp).
+ */
+
+enum TwiStatus
+{
+  TWI_DONE,    // last transaction completed (or none started yet)
+  TWI_BUSY,    // transaction in progress
+  TWI_ERROR,   // last transaction was NACKed or lost the bus
+};
+
+void twiBegin(uint32_t clockHz);   // Enable the bus with its pull-ups at the given SCL rate
+byte twiStatus(void);              // One of TwiStatus
+
+// Start a transaction; false if one is still in progress
+bool twiStart(byte address, const byte *tx, byte txLength, byte *rx, byte rxLength);
+
+// Start a transaction and wait for it; returns its TwiStatus (for setup-time use)
+byte twiTransfer(byte address, const byte *tx, byte txLength, byte *rx, byte rxLength);
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Benchmark: the display following the ambient light
+ *
+ * Runs setup(), sets the brightness to brightnessMax and then changes what the light sensor
+ * reads: a step to dark and one back, a dusk fading over a minute, a level right on a brightness
+ * boundary wobbling by 20 counts, and a light flickering between two levels faster than the
+ * readings come. For each we report how long the shown brightness took to settle, its changes
+ * and the largest step between two of them (in PWM, the size of a visible jump), how often it
+ * turned around (hunting), the strip.show() calls and the EEPROM writes. Needs a firmware build
+ * with -DAMBIENT_LIGHT in FW_DEFINES.
+ */
+
+#include <Arduino.h>
+
+#include "ambient.h"
+#include "menu.h"
+#include "palette.h"
+#include "sim.h"
+
+void setup(void);
+void loop(void);
+
+#ifdef AMBIENT_LIGHT
+
+// From src/main.cpp
+extern byte brightness;
+extern byte brightnessMax;
+extern byte shownBrightness;
+
+struct Follow {
+  uint64_t lastChangeUs;
+  unsigned changes, reversals, maxStep;
+  int      direction;
+};
+
+static Follow follow;
+
+// Run loop() for a while, tracking every change of the shown brightness
+static void runFor(uint64_t us) {
+  uint64_t end = simNow + us;
+  while (simNow < end) {
+    byte before = shownBrightness;
+    loop();
+    if (shownBrightness == before) { continue; }
+
+    int direction = shownBrightness > before ? 1 : -1;
+    int step      = abs((int)paletteLevel(shownBrightness) - paletteLevel(before));
+    if (follow.direction && direction != follow.direction) { follow.reversals++; }
+    follow.direction    = direction;
+    follow.maxStep      = step > (int)follow.maxStep ? step : follow.maxStep;
+    follow.lastChangeUs = simNow;
+    follow.changes++;
+  }
+}
+
+/*
+ * Light over time, set by events every stepUs so it changes while loop() sleeps too
+ */
+
+typedef uint16_t (*LightFn)(uint64_t elapsedUs);
+
+static uint16_t dusk(uint64_t elapsedUs) {
+  return elapsedUs < 60000000 ? 700 - 660 * elapsedUs / 60000000 : 40;
+}
+static uint16_t wobble(uint64_t elapsedUs) { return (elapsedUs / 125000) % 2 ? 380 : 360; }
+static uint16_t flicker(uint64_t elapsedUs) { return (elapsedUs / 10000) % 2 ? 600 : 200; }
+
+static void drive(LightFn light, uint64_t startUs, uint64_t endUs, uint64_t stepUs) {
+  for (uint64_t t = startUs; t < endUs; t += stepUs) {
+    simSchedule(t, [light, startUs, t]() { simSetLight(light(t - startUs)); });
+  }
+}
+
+static void scenario(const char *name, uint16_t startLight, uint64_t us, LightFn light = NULL,
+                     uint64_t stepUs = 0) {
+  simSetLight(startLight);
+  if (light) { drive(light, simNow, simNow + us, stepUs); }
+  follow = Follow();
+
+  uint64_t start  = simNow;
+  uint64_t shows  = simStats.shows;
+  uint64_t writes = simStats.eepromWrites;
+  runFor(us);
+
+  double settled = follow.changes ? (follow.lastChangeUs - start) / 1e6 : 0.0;
+  printf("%-24s | %4u -> %3u | %7.1f | %7u | %8u | %9u | %5llu | %6llu\n", name,
+         paletteLevel(brightness), paletteLevel(shownBrightness), settled, follow.changes,
+         follow.maxStep, follow.reversals, (unsigned long long)(simStats.shows - shows),
+         (unsigned long long)(simStats.eepromWrites - writes));
+}
+
+int main(void) {
+  simSerialOutput(NULL);
+  setup();
+
+  const byte splash = menuPosition;
+  while (menuPosition == splash) { loop(); }
+
+  brightness = brightnessMax;
+  runFor(10000000);
+
+  printf("light                    | PWM set/end | settled | changes | max step | reversals | shows | eeprom\n");
+  printf("                         |             | s       |         | PWM      |           |       | writes\n");
+  scenario("step to dark (40)", 40, 20000000);
+  scenario("step to bright (700)", 700, 20000000);
+  scenario("dusk over 60 s", 700, 80000000, dusk, 100000);
+  scenario("settle at 370", 370, 20000000);
+  scenario("wobble 360/380, 4 Hz", 370, 60000000, wobble, 125000);
+  scenario("settle at 400", 400, 20000000);
+  scenario("flicker 200/600, 50 Hz", 400, 60000000, flicker, 10000);
+  return 0;
+}
+
+#else
+
+int main(void) {
+  printf("bench_ambient needs a firmware build with -DAMBIENT_LIGHT in FW_DEFINES\n");
+  return 1;
+}
+
+#endif
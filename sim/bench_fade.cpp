@@ -0,0 +1,127 @@
+/*
+ * Benchmark: crossfades against the second tick and the buttons
+ *
+ * Runs setup(), then the clock for a while at each update interval, the 1 minute one first
+ * (about one fade a minute, the baseline) and then 1 s (a fade every second), with Down pressed
+ * for 100 ms every 377 ms throughout (a short Down does nothing on the clock, so the display is
+ * only the fades). For each we report the fades, their steps per second and the steps shown,
+ * dropped and held back, the slowest step, how late the second ticks were handled (the start of
+ * the pass that took one against when it was due; only builds without RTC_SQW keep that time)
+ * and how long each Down click waited from the button interrupt seeing it to the start of the
+ * pass that took it, split by whether a fade was running. Needs a firmware build with
+ * -DCROSSFADE in FW_DEFINES.
+ *
+ *   bench_fade [seconds per interval, default 60]
+ */
+
+#include <Arduino.h>
+
+#include "buttons.h"
+#include "fade.h"
+#include "menu.h"
+#include "sim.h"
+
+void setup(void);
+void loop(void);
+
+#ifdef CROSSFADE
+
+// From src/main.cpp
+void setUpdateInterval(unsigned long);
+extern unsigned long lastDisplayUpdate;
+extern unsigned long lastTick;
+extern byte          second;
+
+static const uint8_t pinDown = 8;
+
+struct Waits {
+  unsigned count;
+  uint64_t totalUs, worstUs;
+
+  void add(uint64_t us) {
+    count++;
+    totalUs += us;
+    worstUs = us > worstUs ? us : worstUs;
+  }
+  double meanMs(void) const { return count ? totalUs / 1e3 / count : 0.0; }
+};
+
+static void pressDown(uint64_t fromUs, uint64_t toUs) {
+  for (uint64_t t = fromUs; t < toUs; t += 377000) {
+    simSchedule(t, []() { simPressButton(pinDown, true); });
+    simSchedule(t + 100000, []() { simPressButton(pinDown, false); });
+  }
+}
+
+static void run(unsigned long interval, unsigned seconds) {
+  setUpdateInterval(interval);
+
+  uint16_t fades   = fadesStarted;
+  uint32_t shown   = fadeStepsShown;
+  uint32_t dropped = fadeStepsDropped;
+  uint32_t held    = fadeStepsHeld;
+
+  Waits    ticks = {}, clicksFading = {}, clicksIdle = {};
+  uint64_t end = simNow + seconds * 1000000ULL;
+  pressDown(simNow, end);
+
+  while (simNow < end) {
+    uint64_t      passUs = simNow;
+    unsigned long passMs = millis();
+    bool          fading = passMs - lastDisplayUpdate < FADE_STEPS * FADE_STEP_MS;
+    byte          before = second;
+    loop();
+
+#ifdef RTC_SQW
+    (void)before;
+#else
+    // lastTick is when the second just taken was due
+    if (second != before) {
+      uint64_t dueUs = lastTick * 1000ULL;
+      ticks.add(passUs > dueUs ? passUs - dueUs : 0);
+    }
+#endif
+    if (buttonClicks[BUTTON_DOWN] > 0) {
+      uint64_t waitUs = passUs - buttonClickTime[BUTTON_DOWN] * 1000ULL;
+      (fading ? clicksFading : clicksIdle).add(waitUs);
+    }
+  }
+
+  printf("%11lu | %5u | %7u | %5u | %7u | %4u | %7u | %5.2f / %5.2f | %5.2f / %5.2f / %5.2f\n",
+         interval, fadesStarted - fades, fadeFps(), fadeStepsShown - shown,
+         fadeStepsDropped - dropped, fadeStepsHeld - held, fadeStepUs, ticks.worstUs / 1e3,
+         ticks.meanMs(), clicksFading.meanMs(), clicksIdle.meanMs(),
+         (clicksFading.worstUs > clicksIdle.worstUs ? clicksFading.worstUs : clicksIdle.worstUs) /
+             1e3);
+}
+
+int main(int argc, char **argv) {
+  unsigned seconds = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 10) : 60;
+
+  simSerialOutput(NULL);
+  setup();
+
+  const byte splash = menuPosition;
+  while (menuPosition == splash) { loop(); }
+
+  // Past the first clock frame's fade
+  uint64_t settle = simNow + 1000000;
+  while (simNow < settle) { loop(); }
+
+  printf("interval ms | fades | steps/s | shown | dropped | held | slowest | tick late ms   | "
+         "Down wait ms\n");
+  printf("            |       |         |       |         |      | step us | worst / mean   | "
+         "fading / idle / worst\n");
+  run(60000, seconds);
+  run(1000, seconds);
+  return 0;
+}
+
+#else
+
+int main(void) {
+  printf("bench_fade needs a firmware build with -DCROSSFADE in FW_DEFINES\n");
+  return 1;
+}
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Benchmark: drawing the time, four displayDigit() calls vs one frameRender() sweep
+ *
+ * Both paths draw the same randomized time into the strip buffer, once per refresh, at the same
+ * brightness: the old one through strip.setBrightness(), the sweep from the palette cache built
+ * for it (the default scheme). We report per refresh:
+ *   - strip.setPixelColor() calls
+ *   - estimated AVR cycles from the simulator's cost model (library calls and random draws)
+ *   - host nanoseconds, as a rough guide to the work the cost model does not see: the old
+ *     path's per-pixel PROGMEM list walks and repeated clears, and the sweep's table reads
+ */
+
+#include <Adafruit_NeoPixel.h>
+#include <Arduino.h>
+
+#include <chrono>
+
+#include "frame.h"
+#include "palette.h"
+#include "pattern.h"
+#include "rng.h"
+#include "sim.h"
+
+#ifndef LAYOUT_SECONDS
+
+// From src/main.cpp
+extern Adafruit_NeoPixel strip;
+
+static const byte PROGMEM hourTensLEDs[3]   = { 0, 17, 18 };
+static const byte PROGMEM hourOnesLEDs[9]   = { 1, 2, 3, 16, 15, 14, 19, 20, 21 };
+static const byte PROGMEM minuteTensLEDs[6] = { 4, 5, 13, 12, 22, 23 };
+static const byte PROGMEM minuteOnesLEDs[9] = { 6, 7, 8, 11, 10, 9, 24, 25, 26 };
+
+// The default color scheme
+static const uint32_t colors[DIGIT_GROUPS] = { 0xFF0000, 0x00FF00, 0x0000FF, 0x8B008B };
+
+/*
+ * displayDigit() and clearPixels() as they were before frames
+ */
+static void legacyClearPixels(const byte arr[], byte max, uint32_t color) {
+  for (byte i = 0; i < max; i++) { strip.setPixelColor(pgm_read_byte(&arr[i]), color); }
+}
+
+static void legacyDisplayDigit(byte digit, uint32_t color, uint32_t bgcolor,
+                               const byte pixelList[], byte max, bool randomize) {
+  uint16_t pattern = (1U << digit) - 1;
+
+  if (randomize && digit < max && digit > 0) {
+    const byte *pixels   = strip.getPixels();
+    uint16_t    previous = 0;
+    for (byte i = 0; i < max; i++) {
+      const byte *p = &pixels[pgm_read_byte(&pixelList[i]) * 3];
+      if (p[0] | p[1] | p[2]) { previous |= 1U << i; }
+    }
+    pattern = patternNext(max, digit, previous);
+  }
+
+  legacyClearPixels(pixelList, max, bgcolor);
+
+  for (byte i = 0; i < max; i++) {
+    if (pattern & (1U << i)) { strip.setPixelColor(pgm_read_byte(&pixelList[i]), color); }
+  }
+}
+
+static void legacyDrawTime(byte hour, byte minute) {
+  legacyDisplayDigit(hour / 10, colors[HOUR_TENS], 0, hourTensLEDs, 3, true);
+  legacyDisplayDigit(hour % 10, colors[HOUR_ONES], 0, hourOnesLEDs, 9, true);
+  legacyDisplayDigit(minute / 10, colors[MINUTE_TENS], 0, minuteTensLEDs, 6, true);
+  legacyDisplayDigit(minute % 10, colors[MINUTE_ONES], 0, minuteOnesLEDs, 9, true);
+}
+
+static void frameDrawTime(byte hour, byte minute) {
+  Frame frame;
+  frame.lit = frameRandomDigit(HOUR_TENS, hour / 10) | frameRandomDigit(HOUR_ONES, hour % 10) |
+              frameRandomDigit(MINUTE_TENS, minute / 10) |
+              frameRandomDigit(MINUTE_ONES, minute % 10);
+  for (byte g = 0; g < DIGIT_GROUPS; g++) {
+    frame.color[g] = PALETTE_DIGIT + g;
+    frame.unlit[g] = PALETTE_OFF;
+  }
+  frameRender(frame, strip.getPixels());
+}
+
+typedef void (*DrawFn)(byte, byte);
+
+struct BenchResult {
+  double writes, cycles, hostNs;
+};
+
+static BenchResult runBench(DrawFn fn, unsigned trials) {
+  BenchResult res = {};
+  strip.clear();
+  frameLit = 0;
+
+  uint64_t w0 = simStats.pixelWrites, t0 = simNow;
+  auto     h0 = std::chrono::steady_clock::now();
+  for (unsigned t = 0; t < trials; t++) {
+    // Walk the 12-hour clock so every digit value gets drawn
+    unsigned m = t % (12 * 60);
+    fn(1 + m / 60, m % 60);
+  }
+  auto h1 = std::chrono::steady_clock::now();
+
+  res.writes = (double)(simStats.pixelWrites - w0) / trials;
+  res.cycles = (double)(simNow - t0) * 16 / trials;
+  res.hostNs = std::chrono::duration<double, std::nano>(h1 - h0).count() / trials;
+  return res;
+}
+
+int main(int argc, char **argv) {
+  unsigned trials = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 10) : 200000;
+
+  simSerialOutput(NULL);
+  strip.setBrightness(50);
+  paletteBuild(0, 50);   // the same scale: brightness 50 is left at PWM 50
+
+  // Both paths must produce the same buffer for the same random sequence
+  byte legacy[LAYOUT_PIXELS * 3];
+  for (unsigned m = 0; m < 12 * 60; m++) {
+    rngSeed(m + 1);
+    strip.clear();
+    legacyDrawTime(1 + m / 60, m % 60);
+    memcpy(legacy, strip.getPixels(), sizeof(legacy));
+
+    rngSeed(m + 1);
+    strip.clear();
+    frameLit = 0;
+    frameDrawTime(1 + m / 60, m % 60);
+    if (memcmp(legacy, strip.getPixels(), sizeof(legacy)) != 0) {
+      printf("MISMATCH at %u:%02u\n", 1 + m / 60, m % 60);
+      return 1;
+    }
+  }
+
+  rngSeed(12345);
+  BenchResult o = runBench(legacyDrawTime, trials);
+  rngSeed(12345);
+  BenchResult n = runBench(frameDrawTime, trials);
+
+  printf("per refresh       | displayDigit x4 | frameRender\n");
+  printf("setPixelColor()   | %15.1f | %11.1f\n", o.writes, n.writes);
+  printf("est. AVR cycles   | %15.0f | %11.0f\n", o.cycles, n.cycles);
+  printf("host ns           | %15.1f | %11.1f\n", o.hostNs, n.hostNs);
+  return 0;
+}
+
+#else
+
+int main(void) {
+  printf("bench_frame compares with the old code for the 27-pixel panel, without LAYOUT_SECONDS\n");
+  return 1;
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Benchmark: button-to-display latency in the set-time menu
+ *
+ * Runs setup(), holds Set to get to the set-hours state, then presses Up and Down in turn,
+ * 100 ms each and 377 ms apart so they land all over the blink cycle and the button sampling
+ * period. Then it dumps the latency tracer's histograms: 'total' is what the user sees, of
+ * which 'debounce' and 'click' are set by the button rules and 'render' is loop() and the
+ * strip. Needs a firmware build with -DLATENCY_TRACE (the default FW_DEFINES has it).
+ *
+ * The tracer can only date a raw edge by the first sample that saw it. Knowing when each press
+ * really ended, we also time release to the end of the first show() after it, which includes
+ * the wait for that sample.
+ */
+
+#include <Arduino.h>
+
+#include <vector>
+
+#include "latency.h"
+#include "menu.h"
+#include "sim.h"
+
+void setup(void);
+void loop(void);
+
+#ifdef LATENCY_TRACE
+
+static const uint8_t pinSet = 9, pinUp = 7, pinDown = 8;
+
+static void press(uint64_t atUs, uint8_t pin, uint64_t holdUs) {
+  simSchedule(atUs, [pin]() { simPressButton(pin, true); });
+  simSchedule(atUs + holdUs, [pin]() { simPressButton(pin, false); });
+}
+
+int main(int argc, char **argv) {
+  unsigned presses = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 10) : 1000;
+
+  simSerialOutput(NULL);
+  setup();
+
+  // Let the version splash run out
+  const byte splash = menuPosition;
+  while (menuPosition == splash) { loop(); }
+
+  std::vector<uint64_t> releases, shows;
+  simOnShow = [&shows](const SimStripState &) { shows.push_back(simNow); };
+
+  uint64_t t = simNow + 100000;
+  press(t, pinSet, 1500000);
+  t += 2000000;
+  for (unsigned p = 0; p < presses; p++, t += 377000) {
+    press(t, p & 1 ? pinDown : pinUp, 100000);
+    releases.push_back(t + 100000);
+  }
+
+  // Stop before the set-time timeout
+  while (simNow < t) { loop(); }
+
+  simSerialOutput(stdout);
+  latencyDump();
+
+  // Blink redraws come every 333 ms, so only count a show within 200 ms of the release
+  uint64_t sum = 0, worst = 0, best = UINT64_MAX;
+  unsigned seen = 0;
+  size_t   s    = 0;
+  for (uint64_t r : releases) {
+    while (s < shows.size() && shows[s] < r) { s++; }
+    if (s == shows.size() || shows[s] - r > 200000) { continue; }
+    uint64_t us = shows[s] - r;
+    sum += us;
+    worst = us > worst ? us : worst;
+    best  = us < best ? us : best;
+    seen++;
+  }
+  printf("release to show (us, from the script): %u of %zu presses, min %llu, avg %llu, max %llu\n",
+         seen, releases.size(), (unsigned long long)best,
+         (unsigned long long)(seen ? sum / seen : 0), (unsigned long long)worst);
+  return 0;
+}
+
+#else
+
+int main(void) {
+  printf("bench_latency needs a firmware build with -DLATENCY_TRACE in FW_DEFINES\n");
+  return 1;
+}
+
+#endif
@@ -0,0 +1,49 @@
+/*
+ * Benchmark: loop() passes in the idle display state
+ *
+ * Runs setup() and the version splash, then calls loop() back to back with no input. loop()
+ * sleeps until its next deadline by itself, so the virtual clock runs on between passes. We
+ * report:
+ *   - estimated AVR cycles awake per pass, from the simulator's cost model (library calls only),
+ *     including the timer wake-ups it checks the deadline on while asleep
+ *   - host nanoseconds per pass, as a rough guide to the firmware's own control flow, which the
+ *     cost model does not see
+ *   - passes per simulated second and the share of that time the CPU was awake
+ */
+
+#include <Arduino.h>
+
+#include <chrono>
+
+#include "menu.h"
+#include "sim.h"
+
+void setup(void);
+void loop(void);
+
+int main(int argc, char **argv) {
+  unsigned passes = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 10) : 100000;
+
+  simSerialOutput(NULL);
+  setup();
+
+  const byte splash = menuPosition;
+  while (menuPosition == splash) { loop(); }
+
+  uint64_t t0     = simNow;
+  uint64_t slept0 = simStats.sleptUs;
+  auto     h0     = std::chrono::steady_clock::now();
+  for (unsigned p = 0; p < passes; p++) { loop(); }
+  auto h1 = std::chrono::steady_clock::now();
+
+  uint64_t elapsedUs = simNow - t0;
+  uint64_t awakeUs   = elapsedUs - (simStats.sleptUs - slept0);
+  double   hostNs    = std::chrono::duration<double, std::nano>(h1 - h0).count();
+
+  printf("per idle pass     | loop()\n");
+  printf("est. AVR cycles   | %8.1f\n", (double)awakeUs * 16 / passes);
+  printf("host ns           | %8.1f\n", hostNs / passes);
+  printf("passes per second | %8.2f\n", passes / (elapsedUs / 1e6));
+  printf("awake %%           | %8.4f\n", 100.0 * awakeUs / elapsedUs);
+  return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * Benchmark: digit pattern generation, old shuffle-and-retry loop vs patternNext()
+ *
+ * For every (digit, max) pair the clock can display, a copy of the old displayDigit() and the
+ * same function built on patternNext() are each called repeatedly on the same digit group of the
+ * strip, as successive display refreshes do. We report per call:
+ *   - random draws (avg / worst seen): random() calls for the old loop, rngBelow() ones (rng.h,
+ *     once per call) for patternNext()
+ *   - strip.getPixelColor() read-backs (avg / worst seen)
+ *   - estimated AVR cycles (avg / worst seen) from the simulator's cost model, where a random()
+ *     draw is avr-libc random() plus a 32-bit modulo, an rngBelow() draw its counted shifts,
+ *     xors and multiply, and a read-back at brightness < 255 costs three 32-bit divisions.
+ *     patternNext()'s own table walk (at most max + digit steps) is not charged.
+ *   - total variation distance of each generator's patterns from the exact uniform
+ *     distribution over patterns that change at least one pixel (0 = identical; sampling noise
+ *     alone gives roughly 0.01 at the default trial count)
+ */
+
+#include <Adafruit_NeoPixel.h>
+#include <Arduino.h>
+
+#include <map>
+
+#include "pattern.h"
+#include "rng.h"
+#include "sim.h"
+
+// From src/main.cpp
+extern Adafruit_NeoPixel strip;
+
+static const byte groupLEDs3[] = { 0, 17, 18 };
+static const byte groupLEDs6[] = { 4, 5, 13, 12, 22, 23 };
+static const byte groupLEDs9[] = { 1, 2, 3, 16, 15, 14, 19, 20, 21 };
+
+static const uint32_t color = 0xFF0000;
+
+/*
+ * displayDigit() as it was before patternNext()
+ */
+static void legacyDisplayDigit(byte digit, uint32_t color, uint32_t bgcolor,
+                               const byte pixelList[], byte max, bool randomize) {
+  byte digitOrder[max];
+  for (byte i = 0; i < max; i++) { digitOrder[i] = i; }
+
+  if (digit < max && digit > 0) {
+    while (randomize) {
+      for (byte i = 0; i < max; i++) {
+        byte r = random(0, max);
+        byte t = digitOrder[r];
+
+        digitOrder[r] = digitOrder[i];
+        digitOrder[i] = t;
+      }
+      for (byte i = 0; i < digit; i++) {
+        if (strip.getPixelColor(pgm_read_byte(&pixelList[digitOrder[i]])) == 0) {
+          randomize = false;
+        }
+      }
+    }
+  }
+
+  for (byte i = 0; i < max; i++) { strip.setPixelColor(pgm_read_byte(&pixelList[i]), bgcolor); }
+  for (byte i = 0; i < digit; i++) {
+    strip.setPixelColor(pgm_read_byte(&pixelList[digitOrder[i]]), color);
+  }
+}
+
+/*
+ * displayDigit() on patternNext(), reading the previous pattern from the raw buffer
+ */
+static void patternDisplayDigit(byte digit, uint32_t color, uint32_t bgcolor,
+                                const byte pixelList[], byte max, bool randomize) {
+  uint16_t pattern = (1U << digit) - 1;
+
+  if (randomize && digit < max && digit > 0) {
+    const byte *pixels   = strip.getPixels();
+    uint16_t    previous = 0;
+    for (byte i = 0; i < max; i++) {
+      const byte *p = &pixels[pgm_read_byte(&pixelList[i]) * 3];
+      if (p[0] | p[1] | p[2]) { previous |= 1U << i; }
+    }
+    pattern = patternNext(max, digit, previous);
+  }
+
+  for (byte i = 0; i < max; i++) {
+    strip.setPixelColor(pgm_read_byte(&pixelList[i]), (pattern & (1U << i)) ? color : bgcolor);
+  }
+}
+
+typedef void (*DisplayFn)(byte, uint32_t, uint32_t, const byte[], byte, bool);
+
+static uint16_t readPattern(const byte *leds, byte max) {
+  uint16_t pattern = 0;
+  for (byte i = 0; i < max; i++) {
+    const uint8_t *p = strip.getPixels() + leds[i] * 3;
+    if (p[0] || p[1] || p[2]) { pattern |= 1U << i; }
+  }
+  return pattern;
+}
+
+struct Stat {
+  double   sum;
+  uint64_t max;
+  void     add(uint64_t v) {
+    sum += v;
+    if (v > max) { max = v; }
+  }
+};
+
+struct BenchResult {
+  Stat   draws, reads, cycles;
+  double distance;
+};
+
+static long patternCount(byte n, byte k) {
+  long c = 1;
+  for (byte i = 1; i <= k; i++) { c = c * (n - k + i) / i; }
+  return c;
+}
+
+static BenchResult runBench(DisplayFn fn, const byte *leds, byte max, byte digit,
+                            unsigned trials) {
+  BenchResult res = {};
+
+  // Cost, in steady state: each call sees the pattern left by the previous one
+  strip.clear();
+  fn(digit, color, 0, leds, max, true);
+  for (unsigned t = 0; t < trials; t++) {
+    uint64_t d0 = simStats.randomCalls + simStats.rngDraws;
+    uint64_t r0 = simStats.pixelReads, t0 = simNow;
+
+    fn(digit, color, 0, leds, max, true);
+
+    res.draws.add(simStats.randomCalls + simStats.rngDraws - d0);
+    res.reads.add(simStats.pixelReads - r0);
+    res.cycles.add((simNow - t0) * 16);
+  }
+
+  // Distribution, from a fixed previous pattern: the first 'digit' LEDs of the group lit
+  uint16_t                 previous = (1U << digit) - 1;
+  std::map<uint16_t, long> seen;
+  for (unsigned t = 0; t < trials; t++) {
+    for (byte i = 0; i < max; i++) {
+      strip.setPixelColor(leds[i], (previous & (1U << i)) ? color : 0);
+    }
+    fn(digit, color, 0, leds, max, true);
+    seen[readPattern(leds, max)]++;
+  }
+
+  // Target: uniform over the digit-sized patterns other than the previous one
+  long   others = patternCount(max, digit) - 1;
+  double tvd    = (double)(others - (long)seen.size() + (long)seen.count(previous)) / others;
+  for (auto &s : seen) {
+    tvd += fabs((double)s.second / trials - (s.first == previous ? 0 : 1.0 / others));
+  }
+  res.distance = 0.5 * tvd;
+  return res;
+}
+
+int main(int argc, char **argv) {
+  unsigned trials = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 10) : 20000;
+
+  simSerialOutput(NULL);
+  randomSeed(12345);
+  rngSeed(12345);
+  strip.setBrightness(50);
+
+  struct Group {
+    const byte *leds;
+    byte        max;
+  } groups[] = { { groupLEDs3, 3 }, { groupLEDs6, 6 }, { groupLEDs9, 9 } };
+
+  printf("max digit | draws avg/max   | read-backs avg/max | est. AVR cycles avg/max  | distance\n");
+  printf("          |  old      new   |  old       new     |  old             new     | old    new\n");
+  for (auto &g : groups) {
+    for (byte digit = 1; digit < g.max; digit++) {
+      BenchResult o = runBench(legacyDisplayDigit, g.leds, g.max, digit, trials);
+      BenchResult n = runBench(patternDisplayDigit, g.leds, g.max, digit, trials);
+
+      printf("%3u %4u  | %4.1f/%-3llu %3.1f/%-2llu | %4.1f/%-4llu %3.1f/%-2llu | %6.0f/%-7llu %5.0f/%-5llu |"
+             " %.3f  %.3f\n",
+             g.max, digit, o.draws.sum / trials, (unsigned long long)o.draws.max,
+             n.draws.sum / trials, (unsigned long long)n.draws.max, o.reads.sum / trials,
+             (unsigned long long)o.reads.max, n.reads.sum / trials,
+             (unsigned long long)n.reads.max, o.cycles.sum / trials,
+             (unsigned long long)o.cycles.max, n.cycles.sum / trials,
+             (unsigned long long)n.cycles.max, o.distance, n.distance);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * Benchmark: estimated LED current and the limiter, per color scheme and brightness
+ *
+ * Renders the color scheme chooser's frame (every pixel lit) and a clock frame (9:59, the most
+ * pixels the clock lights) for each scheme at each brightness setting the Up button steps
+ * through, and reports the estimated draw and, where the budget cut it, what it was cut from.
+ * Each estimate, which the renderer adds up as it writes, is checked against one counted from
+ * the frame's lit pixels, the shown one against a rescan of the buffer, and that against the
+ * budget.
+ */
+
+#include <Adafruit_NeoPixel.h>
+#include <Arduino.h>
+
+#include "frame.h"
+#include "palette.h"
+#include "power.h"
+#include "sim.h"
+
+// From src/main.cpp
+extern Adafruit_NeoPixel strip;
+
+static const byte levels[] = { 50, 100, 150, 200, 250 };   // brightnessMin to brightnessMax
+
+static const char *const schemeNames[PALETTE_SCHEMES] = {
+  "Default", "TIX II", "Green/yellow", "Red/orange", "Purple/blue", "Christmas", "Hanukkah"
+};
+
+static Frame chooserFrame(void) {
+  Frame frame;
+  frame.lit = 0;
+  for (byte g = 0; g < DIGIT_GROUPS; g++) {
+    frame.lit |= frameGroup(g);
+    frame.color[g] = PALETTE_DIGIT + g;
+    frame.unlit[g] = PALETTE_OFF;
+  }
+  return frame;
+}
+
+static Frame clockFrame(void) {
+  const byte time[3] = { 0x09, 0x59, 0x59 };
+  Frame      frame   = chooserFrame();
+  frame.lit          = 0;
+  for (byte g = 0; g < DIGIT_GROUPS; g++) { frame.lit |= frameDigit(g, frameTimeDigit(g, time)); }
+  return frame;
+}
+
+// Render a frame; false if the estimate or the limiting is off
+static bool render(const Frame &frame) {
+  frameRender(frame, strip.getPixels());
+
+  // The estimate as if unlimited, from the lit pixels and the palette
+  unsigned long wanted = 0;
+  for (byte g = 0; g < DIGIT_GROUPS; g++) {
+    const byte *rgb = paletteCache[frame.color[g]];
+    wanted += __builtin_popcountll(frame.lit & frameGroup(g)) * (rgb[0] + rgb[1] + rgb[2]);
+  }
+  // and as written, from the buffer
+  unsigned long shown = 0;
+  for (unsigned i = 0; i < LAYOUT_PIXELS * 3; i++) { shown += strip.getPixels()[i]; }
+
+  return powerDemandMa == powerEstimate(wanted) && powerMa == powerEstimate(shown) &&
+         powerMa <= POWER_BUDGET_MA;
+}
+
+static bool table(const char *title, Frame (*make)(void)) {
+  printf("\n%-13s |", title);
+  for (byte level : levels) { printf(" %11u |", level); }
+  printf("\n");
+
+  Frame frame = make();
+  for (byte scheme = 0; scheme < PALETTE_SCHEMES; scheme++) {
+    printf("%-13s |", schemeNames[scheme]);
+    for (byte level : levels) {
+      paletteBuild(scheme, level);
+      if (!render(frame)) {
+        printf("\nESTIMATE MISMATCH, scheme %u brightness %u\n", scheme, level);
+        return false;
+      }
+      if (powerMa == powerDemandMa) {
+        printf(" %11u |", powerMa);
+      } else {
+        printf(" %4u < %4u |", powerMa, powerDemandMa);
+      }
+    }
+    printf("\n");
+  }
+  return true;
+}
+
+int main(void) {
+  simSerialOutput(NULL);
+
+  printf("estimated mA (limited < unlimited), budget %u mA, %u pixels\n", POWER_BUDGET_MA,
+         (unsigned)LAYOUT_PIXELS);
+  if (!table("all lit", chooserFrame) || !table("clock 9:59", clockFrame)) { return 1; }
+  return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Benchmark: pattern random numbers, Arduino random(max) vs rngBelow()
+ *
+ * For each bound the digit patterns draw below (the group sizes, and the pattern counts of the
+ * larger groups), both generators are drawn 100000 times per possible value. We report:
+ *   - estimated AVR cycles per draw, which is the simulator's cost model and not a measurement:
+ *     random() is charged one 32-bit division plus a modulo, rngBelow() a hand count of the
+ *     shifts, xors and 24x8-bit multiply avr-gcc emits for it (sim.h's simCyclesRngBelow), so
+ *     both columns are constants the model charges per draw. Only the board, or a count of the
+ *     instructions in an avr-objdump of the build, can confirm them
+ *   - host ns per draw, for the relative cost of the arithmetic only
+ *   - Pearson's chi-square against the uniform distribution, next to the value a uniform source
+ *     stays below 99.9% of the time for that many degrees of freedom
+ * and the worst deviation from one half of any bit of rngNext() over the same number of draws.
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include <time.h>
+
+#include "rng.h"
+#include "sim.h"
+
+static const unsigned perValue = 100000;
+
+static uint32_t counts[256];
+
+static double hostNs(void) {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double chiSquare(byte bound, unsigned long draws) {
+  double expected = (double)draws / bound, chi = 0;
+  for (unsigned v = 0; v < bound; v++) { chi += (counts[v] - expected) * (counts[v] - expected); }
+  return chi / expected;
+}
+
+// Wilson-Hilferty approximation of the chi-square distribution's 99.9th percentile
+static double chiCritical(unsigned dof) {
+  double k = dof, z = 3.090;
+  double t = 1 - 2 / (9 * k) + z * sqrt(2 / (9 * k));
+  return k * t * t * t;
+}
+
+int main(int argc, char **argv) {
+  unsigned scale = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 10) : perValue;
+
+  simSerialOutput(NULL);
+  randomSeed(12345);
+  rngSeed(12345);
+
+  static const byte bounds[] = { 3, 6, 9, 20, 36, 84, 126 };
+
+  printf("bound | est. AVR cycles | host ns/draw  | chi-square          | 99.9%% limit\n");
+  printf("      | per draw, model |               |                     |\n");
+  printf("      | random() rng    | random() rng  | random()  rng       |\n");
+  for (byte bound : bounds) {
+    unsigned long draws = (unsigned long)scale * bound;
+
+    memset(counts, 0, sizeof(counts));
+    uint64_t t0  = simNow;
+    double   ns0 = hostNs();
+    for (unsigned long i = 0; i < draws; i++) { counts[random(bound)]++; }
+    double   oldNs  = (hostNs() - ns0) / draws;
+    double   oldCyc = (double)(simNow - t0) * 16 / draws;
+    double   oldChi = chiSquare(bound, draws);
+
+    memset(counts, 0, sizeof(counts));
+    t0  = simNow;
+    ns0 = hostNs();
+    for (unsigned long i = 0; i < draws; i++) { counts[rngBelow(bound)]++; }
+    double newNs  = (hostNs() - ns0) / draws;
+    double newCyc = (double)(simNow - t0) * 16 / draws;
+    double newChi = chiSquare(bound, draws);
+
+    printf("%5u | %8.0f %-6.0f | %8.1f %-4.1f | %8.1f  %-8.1f  | %.1f\n", bound, oldCyc,
+           newCyc, oldNs, newNs, oldChi, newChi, chiCritical(bound - 1));
+  }
+
+  unsigned long draws = (unsigned long)scale * 32;
+  uint32_t      ones[32] = {};
+  for (unsigned long i = 0; i < draws; i++) {
+    uint32_t x = rngNext();
+    for (byte b = 0; b < 32; b++) { ones[b] += x >> b & 1; }
+  }
+  double worst = 0;
+  for (byte b = 0; b < 32; b++) { worst = fmax(worst, fabs((double)ones[b] / draws - 0.5)); }
+  printf("\nrngNext() bits over %lu draws: worst off one half by %.5f (noise ~%.5f)\n", draws,
+         worst, 0.5 / sqrt((double)draws));
+  return 0;
+}
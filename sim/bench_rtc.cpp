@@ -0,0 +1,111 @@
+/*
+ * Benchmark: reading the time from the DS3231, blocking vs in the background
+ *
+ * Three ways of getting the time, on the simulated bus with its cost model:
+ *   - RTClib's now(): Wire at its default 100 kHz, all 7 time and date registers, as the clock
+ *     read the RTC before it talked to the chip itself
+ *   - ds3231ReadTime(): the 3 time registers at 400 kHz, waiting for the transfer
+ *   - ds3231RequestTime()/ds3231TimeReady(): the same transfer run by the TWI interrupt while a
+ *     stand-in loop() does 10 us of other work per pass
+ * We report per read the time from asking to having the result, and how much of it loop()
+ * couldn't use (the whole transfer when blocking; the request, the polls and the interrupt
+ * handler when not).
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "bcd.h"
+#include "ds3231.h"
+#include "sim.h"
+
+static const uint32_t loopWorkUs = 10;
+
+static byte bcd2bin(byte v) { return v - 6 * (v >> 4); }
+
+// RTC_DS3231::now() as RTClib implements it
+static void rtclibNow(BcdTime &time) {
+  Wire.beginTransmission(DS3231_ADDRESS);
+  Wire.write((byte)0);
+  Wire.endTransmission();
+
+  Wire.requestFrom((byte)DS3231_ADDRESS, (byte)7);
+  byte ss = bcd2bin(Wire.read() & 0x7F);
+  byte mm = bcd2bin(Wire.read());
+  byte hh = bcd2bin(Wire.read());
+  Wire.read();
+  Wire.read();
+  Wire.read();
+  Wire.read();
+
+  // The clock then split the DateTime back into digits
+  time.second = ((ss / 10) << 4) | (ss % 10);
+  time.minute = ((mm / 10) << 4) | (mm % 10);
+  time.hour   = ((hh / 10) << 4) | (hh % 10);
+}
+
+struct BenchResult {
+  double latencyUs, blockedUs;
+};
+
+static BenchResult runBlocking(void (*read)(BcdTime &), unsigned trials) {
+  BcdTime  time;
+  uint64_t t0 = simNow;
+  for (unsigned t = 0; t < trials; t++) { read(time); }
+  double us = (double)(simNow - t0) / trials;
+  return { us, us };
+}
+
+static BenchResult runAsync(unsigned trials) {
+  BcdTime  time;
+  uint64_t latency = 0, blocked = 0;
+  for (unsigned t = 0; t < trials; t++) {
+    uint64_t t0     = simNow;
+    unsigned passes = 0;
+    ds3231RequestTime();
+    do {
+      simAdvance(loopWorkUs);
+      passes++;
+      ds3231Update();
+    } while (!ds3231TimeReady(time));
+    latency += simNow - t0;
+    blocked += simNow - t0 - passes * loopWorkUs;
+  }
+  return { (double)latency / trials, (double)blocked / trials };
+}
+
+int main(int argc, char **argv) {
+  unsigned trials = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 10) : 10000;
+
+  simSerialOutput(NULL);
+  simRtcSetTime(12, 34, 56);
+  Wire.begin();
+  if (!ds3231Begin()) {
+    printf("RTC not found\n");
+    return 1;
+  }
+
+  // All three must read the same registers
+  BcdTime a, b, c;
+  rtclibNow(a);
+  ds3231ReadTime(b);
+  ds3231RequestTime();
+  while (!ds3231TimeReady(c)) {
+    simAdvance(loopWorkUs);
+    ds3231Update();
+  }
+  if (a.hour != b.hour || a.minute != b.minute || b.hour != c.hour || b.minute != c.minute) {
+    printf("MISMATCH %02X:%02X / %02X:%02X / %02X:%02X\n", a.hour, a.minute, b.hour, b.minute,
+           c.hour, c.minute);
+    return 1;
+  }
+
+  BenchResult r = runBlocking(rtclibNow, trials);
+  BenchResult w = runBlocking(ds3231ReadTime, trials);
+  BenchResult n = runAsync(trials);
+
+  printf("per read          | RTClib 100 kHz | blocking 400 kHz | background 400 kHz\n");
+  printf("latency us        | %14.1f | %16.1f | %18.1f\n", r.latencyUs, w.latencyUs, n.latencyUs);
+  printf("loop() blocked us | %14.1f | %16.1f | %18.1f\n", r.blockedUs, w.blockedUs, n.blockedUs);
+  return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * Benchmark: how stale the displayed time gets, per update interval
+ *
+ * For each update interval setting, powers the clock up at several points of the RTC's minute
+ * (one forked run each, so every run starts from reset) and lets it run with no input. Every
+ * 10 ms of virtual time it compares the digits on the strip with the DS3231's time. The digits
+ * are counted from the lit pixels of each group. Each minute rollover leaves the display stale
+ * until the clock redraws. We report per setting the longest and the average of those stale
+ * spells, to the 10 ms sampling step.
+ *
+ *   bench_stale [minutes per run, default 10] [RTC drift in ppm, as tixsim --rtc-ppm]
+ */
+
+#include <Arduino.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "frame.h"
+#include "menu.h"
+#include "sim.h"
+
+void setup(void);
+void loop(void);
+
+// From src/main.cpp
+void setUpdateInterval(unsigned long);
+
+static const uint64_t sampleUs = 10000;
+static const unsigned phases   = 12;
+
+struct StaleStats {
+  uint64_t worstUs;
+  uint64_t totalUs;
+  unsigned spells;
+};
+
+static uint8_t    shown[DIGIT_GROUPS];   // digits on the strip
+static bool       stale      = false;
+static uint64_t   staleSince = 0;
+static StaleStats stats      = {};
+
+static void countDigits(const SimStripState &state) {
+  memset(shown, 0, sizeof(shown));
+  for (uint16_t p = 0; p < state.count; p++) {
+    const uint8_t *px = &state.pixels[p * 3];
+    if (px[0] || px[1] || px[2]) { shown[pixelGroup(p)]++; }
+  }
+}
+
+static bool showsRtcTime(void) {
+  uint8_t hour, minute, second;
+  simRtcGetTime(hour, minute, second);
+  uint8_t hours = LAYOUT_HOURS == 24 ? hour : hour % 12 == 0 ? 12 : hour % 12;
+
+  return shown[HOUR_TENS] == hours / 10 && shown[HOUR_ONES] == hours % 10 &&
+         shown[MINUTE_TENS] == minute / 10 && shown[MINUTE_ONES] == minute % 10;
+}
+
+static void sample(void) {
+  if (!showsRtcTime()) {
+    if (!stale) { staleSince = simNow; }
+    stale = true;
+  } else if (stale) {
+    uint64_t us   = simNow - staleSince;
+    stats.worstUs = us > stats.worstUs ? us : stats.worstUs;
+    stats.totalUs += us;
+    stats.spells++;
+    stale = false;
+  }
+  simSchedule(simNow + sampleUs, sample);
+}
+
+// One run from reset, powered up phaseUs into the RTC's minute
+static void run(unsigned long interval, uint64_t phaseUs, unsigned minutes, long ppm) {
+  simSerialOutput(NULL);
+  simRtcSetDrift(ppm);
+  simOnShow = countDigits;
+  simAdvance(phaseUs);
+  setup();
+
+  const byte splash = menuPosition;
+  while (menuPosition == splash) { loop(); }
+
+  setUpdateInterval(interval);
+  sample();
+
+  uint64_t end = simNow + minutes * 60000000ULL;
+  while (simNow < end) { loop(); }
+}
+
+int main(int argc, char **argv) {
+  unsigned minutes = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 10) : 10;
+  long     ppm     = argc > 2 ? strtol(argv[2], NULL, 10) : 0;
+
+  static const unsigned long intervals[] = { 1000, 4000, 60000 };
+
+  printf("interval ms | stale spells | worst stale ms | average stale ms\n");
+  fflush(stdout);
+  for (unsigned long interval : intervals) {
+    StaleStats all = {};
+    for (unsigned p = 0; p < phases; p++) {
+      // Spread over the minute, and over the second too
+      uint64_t phaseUs = p * 5000000ULL + p * 83000ULL;
+
+      int fds[2];
+      if (pipe(fds) != 0) { return 1; }
+      pid_t pid = fork();
+      if (pid == 0) {
+        close(fds[0]);
+        run(interval, phaseUs, minutes, ppm);
+        _exit(write(fds[1], &stats, sizeof(stats)) == sizeof(stats) ? 0 : 1);
+      }
+
+      close(fds[1]);
+      StaleStats one = {};
+      bool       got = read(fds[0], &one, sizeof(one)) == sizeof(one);
+      close(fds[0]);
+      waitpid(pid, NULL, 0);
+      if (!got) { return 1; }
+
+      all.worstUs = one.worstUs > all.worstUs ? one.worstUs : all.worstUs;
+      all.totalUs += one.totalUs;
+      all.spells += one.spells;
+    }
+
+    printf("%11lu | %12u | %14.0f | %16.0f\n", interval, all.spells, all.worstUs / 1e3,
+           all.spells ? all.totalUs / 1e3 / all.spells : 0.0);
+  }
+  return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef ADAFRUIT_NEOPIXEL_H
+#define ADAFRUIT_NEOPIXEL_H
+
+/*
+ * Host stand-in for Adafruit_NeoPixel
+ *
+ * Keeps a real pixel buffer and reproduces the library's brightness handling (scaling on write,
+ * destructive rescale in setBrightness(), lossy un-scaling in getPixelColor()) so rendering code
+ * sees the same values it would on the board. show() charges the WS2812 transfer time.
+ */
+
+#include <Arduino.h>
+
+// Pixel type flags, as in the library: bits 5-4 red offset, 3-2 green, 1-0 blue
+#define NEO_RGB ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_RBG ((0 << 6) | (0 << 4) | (2 << 2) | (1))
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_GBR ((2 << 6) | (2 << 4) | (0 << 2) | (1))
+#define NEO_BRG ((1 << 6) | (1 << 4) | (2 << 2) | (0))
+#define NEO_BGR ((2 << 6) | (2 << 4) | (1 << 2) | (0))
+
+#define NEO_KHZ800 0x0000
+#define NEO_KHZ400 0x0100
+
+typedef uint16_t neoPixelType;
+
+class Adafruit_NeoPixel {
+ public:
+  Adafruit_NeoPixel(uint16_t n, uint16_t pin = 6, neoPixelType type = NEO_GRB + NEO_KHZ800);
+  ~Adafruit_NeoPixel();
+
+  void     begin(void);
+  void     show(void);
+  void     setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+  void     setPixelColor(uint16_t n, uint32_t c);
+  void     fill(uint32_t c = 0, uint16_t first = 0, uint16_t count = 0);
+  void     setBrightness(uint8_t);
+  void     clear(void);
+  uint8_t *getPixels(void) const { return pixels; }
+  uint8_t  getBrightness(void) const { return brightness - 1; }
+  uint16_t numPixels(void) const { return numLEDs; }
+  uint32_t getPixelColor(uint16_t n) const;
+
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+
+ private:
+  uint16_t numLEDs;
+  uint16_t numBytes;
+  uint8_t  brightness;
+  uint8_t *pixels;
+  uint8_t  rOffset, gOffset, bOffset;
+};
+
+#endif
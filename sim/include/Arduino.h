@@ -0,0 +1,148 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+/*
+ * Host stand-in for the Arduino AVR core
+ *
+ * Only the parts of the core the firmware uses are provided. Timing functions read the
+ * simulator's virtual clock and every call charges its approximate AVR cost to it.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avr/pgmspace.h>
+
+#include "binary.h"
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+
+#define NUM_DIGITAL_PINS 20
+
+// Same definition as Arduino.h (arguments may be evaluated twice)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+/*
+ * Time
+ */
+
+unsigned long millis(void);
+unsigned long micros(void);
+void          delay(unsigned long ms);
+void          delayMicroseconds(unsigned int us);
+
+/*
+ * Digital and analog I/O
+ */
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+int  analogRead(uint8_t pin);
+
+/*
+ * Random numbers (same generator as avr-libc, so seeds give the same sequences as the board)
+ */
+
+void randomSeed(unsigned long seed);
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+/*
+ * Printing
+ */
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) = 0;
+  size_t         write(const uint8_t *buffer, size_t size);
+  size_t         write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+
+  size_t print(const __FlashStringHelper *);
+  size_t print(const char[]);
+  size_t print(char);
+  size_t print(unsigned char, int = DEC);
+  size_t print(int, int = DEC);
+  size_t print(unsigned int, int = DEC);
+  size_t print(long, int = DEC);
+  size_t print(unsigned long, int = DEC);
+  size_t print(double, int = 2);
+
+  size_t println(const __FlashStringHelper *);
+  size_t println(const char[]);
+  size_t println(char);
+  size_t println(unsigned char, int = DEC);
+  size_t println(int, int = DEC);
+  size_t println(unsigned int, int = DEC);
+  size_t println(long, int = DEC);
+  size_t println(unsigned long, int = DEC);
+  size_t println(double, int = 2);
+  size_t println(void);
+
+ private:
+  size_t printNumber(unsigned long, uint8_t);
+};
+
+class HardwareSerial : public Print {
+ public:
+  void   begin(unsigned long baud);
+  void   end() {}
+  int    available(void);
+  int    peek(void);
+  int    read(void);
+  int    availableForWrite(void);
+  void   flush(void);
+  size_t write(uint8_t);
+  using Print::write;
+  operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+/*
+ * Interrupts
+ *
+ * External interrupts 0 and 1 on pins 2 and 3, as on the ATmega328P. Handlers run from inside
+ * whatever fake call advances the virtual clock past the edge, or from interrupts() if they
+ * were held off by noInterrupts().
+ */
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+
+void interrupts(void);
+void noInterrupts(void);
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef EEPROM_h
+#define EEPROM_h
+
+/*
+ * Host stand-in for the AVR core's EEPROM library (1 KB, ATmega328P)
+ *
+ * Like the real put(), writes go through update() and only cells whose value changes are
+ * programmed. Every programmed cell charges the 3.3 ms erase/write time to the virtual clock.
+ */
+
+#include <Arduino.h>
+
+#define E2END 0x3FF
+
+struct EEPROMClass {
+  uint8_t  read(int idx);
+  void     write(int idx, uint8_t val);
+  void     update(int idx, uint8_t val);
+  uint16_t length() { return E2END + 1; }
+
+  template <typename T>
+  T &get(int idx, T &t) {
+    uint8_t *ptr = (uint8_t *)&t;
+    for (int count = sizeof(T); count; --count, ++idx) *ptr++ = read(idx);
+    return t;
+  }
+
+  template <typename T>
+  const T &put(int idx, const T &t) {
+    const uint8_t *ptr = (const uint8_t *)&t;
+    for (int count = sizeof(T); count; --count, ++idx) update(idx, *ptr++);
+    return t;
+  }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
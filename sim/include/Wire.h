@@ -0,0 +1,40 @@
+#ifndef TwoWire_h
+#define TwoWire_h
+
+/*
+ * Host stand-in for the Wire (TWI master) library
+ *
+ * Transactions are routed to the simulated I2C devices and block for the time the transfer
+ * would take on the bus at the configured clock.
+ */
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH 32
+
+class TwoWire : public Print {
+ public:
+  void    begin(void);
+  void    setClock(uint32_t clock);
+  void    beginTransmission(uint8_t address);
+  uint8_t endTransmission(uint8_t sendStop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop = true);
+  size_t  write(uint8_t data);
+  using Print::write;
+  int available(void);
+  int read(void);
+  int peek(void);
+
+ private:
+  uint32_t clockHz = 100000;
+  uint8_t  txAddress;
+  uint8_t  txBuffer[BUFFER_LENGTH];
+  uint8_t  txLength;
+  uint8_t  rxBuffer[BUFFER_LENGTH];
+  uint8_t  rxIndex;
+  uint8_t  rxLength;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef __PGMSPACE_H_
+#define __PGMSPACE_H_
+
+/*
+ * Host stand-in for avr-libc's program memory helpers: flash and RAM are the same address
+ * space here, so the accessors are plain loads.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(void *const *)(addr))
+
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#endif
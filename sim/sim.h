@@ -0,0 +1,169 @@
+#ifndef TIX_SIM_H
+#define TIX_SIM_H
+
+/*
+ * Host simulator control interface
+ *
+ * The firmware in ../src is compiled unchanged against the fake Arduino, NeoPixel, EEPROM and
+ * Wire headers in sim/include. All of those fakes share the virtual clock declared here: time
+ * only moves when a fake charges the cost of what it just did (a pixel write, an I2C byte, an
+ * EEPROM cell) or when the driver fast-forwards between loop() calls.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <functional>
+
+/*
+ * Virtual clock
+ */
+
+extern uint64_t simNow;   // µs since simulated reset
+
+// Move the clock forward by us microseconds, running any events that fall due on the way
+void simAdvance(uint64_t us);
+
+// Run fn once the clock reaches atUs (events at the same time run in scheduling order)
+void simSchedule(uint64_t atUs, std::function<void()> fn);
+
+/*
+ * Approximate cost (µs) of blocking operations on a 16 MHz ATmega328P
+ */
+
+const uint32_t simCostMillis        = 1;
+const uint32_t simCostMicros        = 2;
+const uint32_t simCostDigitalIO     = 3;
+const uint32_t simCostAnalogRead    = 112;
+const uint32_t simCostDivide32      = 40;   // __udivmodsi4
+const uint32_t simCostRandom        = 90;   // avr-libc random() (one ldiv) plus Arduino's modulo
+const uint32_t simCostPixelWrite    = 2;
+const uint32_t simCostPixelRead     = 2;    // plus three 32-bit divides when brightness is set
+const uint32_t simCostShowPerPixel  = 30;
+const uint32_t simCostShowLatch     = 50;
+const uint32_t simCostSerialEnqueue = 5;
+const uint32_t simCostTwiInterrupt  = 5;   // TWI_vect entry, one state step, exit
+const uint32_t simCostTwiPoll       = 1;   // one twiStatus() check while spinning
+const uint32_t simCostButtonSample  = 6;   // TIMER0_COMPA_vect sampling and debouncing the buttons
+const uint32_t simCostAmbientSample = 3;   // ADC_vect adding one conversion to the light reading
+const uint32_t simCostRngTimeout    = 25;   // WDT_vect stirring one sample into the pattern RNG
+const uint32_t simCostEepromRead    = 1;
+const uint32_t simCostEepromWrite   = 3300;
+const uint32_t simSerialTxBuffer    = 64;
+
+/*
+ * Approximate cost (cycles) of firmware arithmetic the host runs natively, counted by hand from
+ * its operations as avr-gcc -Os emits them, not measured. A 32-bit value is four registers: a
+ * shift by one bit is four instructions, a shift by whole bytes is register moves, an xor or a
+ * load/store four of each.
+ */
+
+const uint32_t simCyclesPerUs     = 16;
+const uint32_t simCyclesShiftBit  = 4;    // lsl/lsr and three rol/ror
+const uint32_t simCyclesShiftByte = 4;    // mov (and clr) per byte
+const uint32_t simCyclesXor       = 4;
+const uint32_t simCyclesLoadStore = 16;   // four lds and four sts
+const uint32_t simCyclesCall      = 8;    // rcall and ret
+const uint32_t simCyclesMultiply  = 24;   // __umulhisi3-style 24x8 with hardware MUL, and its call
+
+// rng.h: x ^= x << 13 (one byte, five bits), x ^= x >> 17 (two bytes, one bit), x ^= x << 5
+const uint32_t simCyclesRngNext = simCyclesCall + simCyclesLoadStore + 3 * simCyclesXor +
+                                  3 * simCyclesShiftByte + 11 * simCyclesShiftBit;
+// plus >> 8 and >> 24 (byte moves) around the multiply by the bound
+const uint32_t simCyclesRngBelow = simCyclesRngNext + 2 * simCyclesShiftByte + simCyclesMultiply;
+
+/*
+ * Pins
+ */
+
+void simPullLow(uint8_t pin, bool low);           // Drive an open-drain line into a pin
+void simPressButton(uint8_t pin, bool pressed);   // Drive an active-low button pin
+bool simPinLevel(uint8_t pin);
+
+/*
+ * Idle sleep: advance to Timer0's next millis() interrupt, or to the next queued event if that
+ * comes first, and count the time in simStats.sleptUs
+ */
+
+void simSleep(void);
+
+/*
+ * Simulated DS3231
+ *
+ * Its SQW/INT output is wired to simRtcSqwPin. When the firmware selects the 1 Hz square wave,
+ * the line goes low as the seconds register advances and high again 500 ms later.
+ */
+
+const uint8_t simRtcSqwPin = 2;
+
+void simRtcSetTime(uint8_t hour, uint8_t minute, uint8_t second);
+void simRtcSetLostPower(bool lost);
+void simRtcSetDrift(int32_t ppm);   // Run the RTC's oscillator ppm fast (or slow) from here on
+void simRtcGetTime(uint8_t &hour, uint8_t &minute, uint8_t &second);
+
+/*
+ * Ambient light: what the photoresistor divider reads (0-1023), 700 (bright) until set
+ */
+
+void simSetLight(uint16_t reading);
+
+/*
+ * I2C bus, shared by the Wire stand-in and the firmware's TWI engine
+ */
+
+// Bus time of a transfer of 'bytes' bytes (address byte included): 9 bits each plus START/STOP
+uint64_t simI2cBusUs(uint32_t clockHz, uint8_t bytes);
+
+// Deliver a write / fetch a read at a device, without bus timing; false if nothing answers
+bool simI2cWrite(uint8_t address, const uint8_t *data, uint8_t length);
+bool simI2cRead(uint8_t address, uint8_t *data, uint8_t length);
+
+/*
+ * Serial port
+ */
+
+void simSerialOutput(FILE *out);          // Output sink (NULL discards everything)
+void simSerialInput(const char *text);   // Queue bytes for Serial.read()
+
+/*
+ * EEPROM image persistence
+ */
+
+bool simEepromLoad(const char *path);
+bool simEepromSave(const char *path);
+
+/*
+ * NeoPixel observation
+ */
+
+struct SimStripState {
+  uint16_t       count;
+  const uint8_t *pixels;   // count * 3 bytes in wire order
+  uint8_t        rOffset, gOffset, bOffset;
+};
+
+// Called after every strip.show() with the data that was just pushed to the LEDs
+extern std::function<void(const SimStripState &)> simOnShow;
+
+/*
+ * Counters collected by the fakes
+ */
+
+struct SimStats {
+  uint64_t loops;
+  uint64_t shows;
+  uint64_t pixelWrites;
+  uint64_t pixelReads;
+  uint64_t randomCalls;
+  uint64_t rngDraws;
+  uint64_t serialBytes;
+  uint64_t serialBlockedUs;
+  uint64_t i2cTransactions;
+  uint64_t i2cBusUs;
+  uint64_t eepromWrites;
+  uint64_t eepromBlockedUs;
+  uint64_t sleptUs;
+};
+extern SimStats simStats;
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * The platform part of the firmware's ambient light sensor (include/ambient.h) on the simulator
+ *
+ * The ADC's conversion interrupt is a recurring event, one per Timer0 overflow as on the board,
+ * that charges its CPU time when it runs. Each conversion reads the light level set at that
+ * moment, with an LSB or two of noise, and every AMBIENT_SAMPLES of them make a reading.
+ */
+
+#include "ambient.h"
+#include "sim.h"
+
+static uint16_t simLight = 700;
+static uint64_t simNextConversion;
+
+void simSetLight(uint16_t reading) { simLight = reading; }
+
+static void convert(void) {
+  static uint32_t noise = 0x9E3779B9;
+  static uint16_t sum   = 0;
+  static byte     count = 0;
+
+  noise = noise * 1664525 + 1013904223;
+  simAdvance(simCostAmbientSample);
+  sum += constrain((int)simLight + (int)(noise >> 30) - 1, 0, 1023);
+  if (++count == AMBIENT_SAMPLES) {
+    ambientSample(sum);
+    sum   = 0;
+    count = 0;
+  }
+
+  simNextConversion += 1024;
+  simSchedule(simNextConversion, convert);
+}
+
+void ambientStart(void) {
+  simNextConversion = simNow + 1024;
+  simSchedule(simNextConversion, convert);
+}
@@ -0,0 +1,30 @@
+/*
+ * The platform part of the firmware's buttons (include/buttons.h) on the simulator
+ *
+ * The sampling interrupt is a recurring event that reads the simulated pins, charging the
+ * handler's CPU time when it runs.
+ */
+
+#include "buttons.h"
+#include "sim.h"
+
+static byte     simButtonPins[BUTTONS];
+static uint64_t simNextSample;
+
+static void sampleButtons(void) {
+  byte pressed = 0;
+  for (byte b = 0; b < BUTTONS; b++) {
+    if (!simPinLevel(simButtonPins[b])) { pressed |= 1 << b; }
+  }
+  simAdvance(simCostButtonSample);
+  buttonsSample(pressed);
+
+  simNextSample += BUTTON_SAMPLE_US;
+  simSchedule(simNextSample, sampleButtons);
+}
+
+void buttonsStart(const byte pins[BUTTONS]) {
+  for (byte b = 0; b < BUTTONS; b++) { simButtonPins[b] = pins[b]; }
+  simNextSample = simNow + BUTTON_SAMPLE_US;
+  simSchedule(simNextSample, sampleButtons);
+}
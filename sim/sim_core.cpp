@@ -0,0 +1,365 @@
+/*
+ * Virtual clock, event queue, pins, random numbers and Serial for the host simulator
+ */
+
+#include <Arduino.h>
+
+#include <deque>
+#include <map>
+
+#include "sim.h"
+
+uint64_t simNow = 0;
+SimStats simStats;
+
+/*
+ * Virtual clock and event queue
+ */
+
+typedef std::multimap<uint64_t, std::function<void()>> SimEventQueue;
+
+// Function-local so the fakes can charge time from the firmware's global constructors
+static SimEventQueue &simEvents(void) {
+  static SimEventQueue queue;
+  return queue;
+}
+
+void simSchedule(uint64_t atUs, std::function<void()> fn) {
+  simEvents().insert(std::make_pair(atUs, fn));
+}
+
+void simAdvance(uint64_t us) {
+  SimEventQueue &events = simEvents();
+  uint64_t       target = simNow + us;
+
+  while (!events.empty() && events.begin()->first <= target) {
+    std::function<void()> fn = events.begin()->second;
+    if (events.begin()->first > simNow) { simNow = events.begin()->first; }
+    events.erase(events.begin());
+    fn();
+  }
+
+  // An event may itself have charged time past the target
+  if (simNow < target) { simNow = target; }
+}
+
+unsigned long millis(void) {
+  simAdvance(simCostMillis);
+  return (unsigned long)(simNow / 1000);
+}
+
+unsigned long micros(void) {
+  simAdvance(simCostMicros);
+  return (unsigned long)simNow;
+}
+
+void delay(unsigned long ms) { simAdvance((uint64_t)ms * 1000); }
+
+void delayMicroseconds(unsigned int us) { simAdvance(us); }
+
+/*
+ * Interrupts
+ */
+
+#define SIM_EXT_INTERRUPTS 2
+
+struct SimInterrupt {
+  void (*handler)(void);
+  int  mode;
+  bool pending;
+};
+
+static SimInterrupt extInterrupts[SIM_EXT_INTERRUPTS];
+static bool         interruptsEnabled = true;
+
+static void runPendingInterrupts(void) {
+  for (uint8_t i = 0; i < SIM_EXT_INTERRUPTS && interruptsEnabled; i++) {
+    SimInterrupt &irq = extInterrupts[i];
+    if (!irq.pending || !irq.handler) { continue; }
+
+    // Handlers run with interrupts off, as on the AVR
+    irq.pending       = false;
+    interruptsEnabled = false;
+    irq.handler();
+    interruptsEnabled = true;
+  }
+}
+
+void interrupts(void) {
+  interruptsEnabled = true;
+  runPendingInterrupts();
+}
+
+void noInterrupts(void) { interruptsEnabled = false; }
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode) {
+  if (interruptNum >= SIM_EXT_INTERRUPTS) { return; }
+  extInterrupts[interruptNum].handler = userFunc;
+  extInterrupts[interruptNum].mode    = mode;
+  extInterrupts[interruptNum].pending = false;
+}
+
+void detachInterrupt(uint8_t interruptNum) {
+  if (interruptNum < SIM_EXT_INTERRUPTS) { extInterrupts[interruptNum].handler = NULL; }
+}
+
+/*
+ * Idle sleep
+ *
+ * Until Timer0's next millis() interrupt, or until the next queued event if that comes first:
+ * events are what the outside world does to the pins and buses, so any of them may raise an
+ * interrupt. Waking for one that doesn't only costs the firmware another check.
+ */
+
+void simSleep(void) {
+  SimEventQueue &events = simEvents();
+  uint64_t       wake   = (simNow / 1000 + 1) * 1000;
+  if (!events.empty() && events.begin()->first < wake) { wake = events.begin()->first; }
+
+  simStats.sleptUs += wake - simNow;
+  simAdvance(wake - simNow);
+}
+
+/*
+ * Pins
+ *
+ * Buttons and open-drain outputs such as the DS3231's SQW are modelled as switches to ground:
+ * a pin pulled low reads LOW, a released one reads whatever the pin mode gives (HIGH with the
+ * pull-up enabled, LOW when floating). Level changes on pins 2 and 3 raise their interrupts.
+ */
+
+struct SimPin {
+  uint8_t mode;
+  uint8_t out;
+  bool    pulledLow;
+};
+
+static SimPin pins[NUM_DIGITAL_PINS];
+
+bool simPinLevel(uint8_t pin) {
+  if (pin >= NUM_DIGITAL_PINS) { return false; }
+  if (pins[pin].pulledLow) { return false; }
+  // An input with its output latch high has the pull-up enabled
+  return pins[pin].out == HIGH;
+}
+
+// Raise the pin's external interrupt if the level change matches its mode
+static void pinChanged(uint8_t pin, bool wasHigh) {
+  int num = digitalPinToInterrupt(pin);
+  if (num == NOT_AN_INTERRUPT) { return; }
+
+  bool          isHigh = simPinLevel(pin);
+  SimInterrupt &irq    = extInterrupts[num];
+  if (isHigh == wasHigh || !irq.handler) { return; }
+  if (irq.mode == CHANGE || (irq.mode == FALLING && !isHigh) || (irq.mode == RISING && isHigh) ||
+      (irq.mode == LOW && !isHigh)) {
+    irq.pending = true;
+    runPendingInterrupts();
+  }
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  simAdvance(simCostDigitalIO);
+  if (pin >= NUM_DIGITAL_PINS) { return; }
+  bool wasHigh   = simPinLevel(pin);
+  pins[pin].mode = mode;
+  pins[pin].out  = (mode == INPUT_PULLUP) ? HIGH : LOW;
+  pinChanged(pin, wasHigh);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  simAdvance(simCostDigitalIO);
+  if (pin >= NUM_DIGITAL_PINS) { return; }
+  bool wasHigh  = simPinLevel(pin);
+  pins[pin].out = val ? HIGH : LOW;
+  pinChanged(pin, wasHigh);
+}
+
+int digitalRead(uint8_t pin) {
+  simAdvance(simCostDigitalIO);
+  return simPinLevel(pin) ? HIGH : LOW;
+}
+
+void simPullLow(uint8_t pin, bool low) {
+  if (pin >= NUM_DIGITAL_PINS) { return; }
+  bool wasHigh        = simPinLevel(pin);
+  pins[pin].pulledLow = low;
+  pinChanged(pin, wasHigh);
+}
+
+void simPressButton(uint8_t pin, bool pressed) { simPullLow(pin, pressed); }
+
+int analogRead(uint8_t pin) {
+  // A floating input wanders around mid-scale with a few LSBs of noise
+  static uint32_t noise = 0x2545F491;
+  simAdvance(simCostAnalogRead);
+  noise = noise * 1664525 + 1013904223;
+  return 300 + pin + (int)((noise >> 24) & 0x07);
+}
+
+/*
+ * Random numbers - avr-libc's random() (Park-Miller minimal standard) with Arduino's wrappers
+ */
+
+static uint32_t randomNext = 1;
+
+static int32_t avrRandom(void) {
+  int32_t x = (int32_t)randomNext;
+  if (x == 0) { x = 123459876L; }
+  int32_t hi = x / 127773L;
+  int32_t lo = x % 127773L;
+  x          = 16807L * lo - 2836L * hi;
+  if (x < 0) { x += 0x7fffffffL; }
+  randomNext = (uint32_t)x;
+  return (int32_t)((uint32_t)x % 0x80000000UL);
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) { randomNext = (uint32_t)seed; }
+}
+
+long random(long howbig) {
+  simAdvance(simCostRandom);
+  simStats.randomCalls++;
+  if (howbig == 0) { return 0; }
+  return avrRandom() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) { return howsmall; }
+  return random(howbig - howsmall) + howsmall;
+}
+
+/*
+ * Print
+ */
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) { n += write(*buffer++); }
+  return n;
+}
+
+size_t Print::print(const __FlashStringHelper *s) { return write((const char *)s); }
+size_t Print::print(const char s[]) { return write(s); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char b, int base) { return print((unsigned long)b, base); }
+size_t Print::print(int n, int base) { return print((long)n, base); }
+size_t Print::print(unsigned int n, int base) { return print((unsigned long)n, base); }
+
+size_t Print::print(long n, int base) {
+  if (base == 0) { return write((uint8_t)n); }
+  if (base == 10 && n < 0) { return print('-') + printNumber((unsigned long)-n, 10); }
+  // Non-decimal bases print the two's complement bit pattern of the AVR's 32-bit long
+  return printNumber((uint32_t)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  if (base == 0) { return write((uint8_t)n); }
+  return printNumber(n, base);
+}
+
+size_t Print::print(double number, int digits) {
+  char buf[40];
+  snprintf(buf, sizeof(buf), "%.*f", digits, number);
+  return write(buf);
+}
+
+size_t Print::println(void) { return write("\r\n"); }
+size_t Print::println(const __FlashStringHelper *s) { return print(s) + println(); }
+size_t Print::println(const char s[]) { return print(s) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char b, int base) { return print(b, base) + println(); }
+size_t Print::println(int n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned int n, int base) { return print(n, base) + println(); }
+size_t Print::println(long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long n, int base) { return print(n, base) + println(); }
+size_t Print::println(double n, int digits) { return print(n, digits) + println(); }
+
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+  char  buf[8 * sizeof(long) + 1];
+  char *str = &buf[sizeof(buf) - 1];
+
+  *str = '\0';
+  if (base < 2) { base = 10; }
+  do {
+    char c = n % base;
+    n /= base;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+
+  return write(str);
+}
+
+/*
+ * HardwareSerial
+ *
+ * Bytes leave the 64-byte transmit buffer at the configured baud rate. A write into a full
+ * buffer blocks (advancing the virtual clock) until the UART has shifted a byte out, exactly
+ * like the AVR core does with interrupts enabled.
+ */
+
+HardwareSerial Serial;
+
+static FILE               *serialOut      = stdout;
+static uint64_t            serialByteNs   = 86806;   // 10 bits at 115200 baud
+static uint64_t            serialTxDoneNs = 0;       // when the last queued byte finishes
+static std::deque<uint8_t> serialRx;
+
+void simSerialOutput(FILE *out) { serialOut = out; }
+
+void simSerialInput(const char *text) {
+  while (*text) { serialRx.push_back((uint8_t)*text++); }
+}
+
+static uint32_t serialTxQueued(void) {
+  uint64_t nowNs = simNow * 1000;
+  if (serialTxDoneNs <= nowNs) { return 0; }
+  return (uint32_t)((serialTxDoneNs - nowNs + serialByteNs - 1) / serialByteNs);
+}
+
+void HardwareSerial::begin(unsigned long baud) { serialByteNs = 10000000000ULL / baud; }
+
+int HardwareSerial::available(void) { return (int)serialRx.size(); }
+
+int HardwareSerial::peek(void) { return serialRx.empty() ? -1 : serialRx.front(); }
+
+int HardwareSerial::read(void) {
+  if (serialRx.empty()) { return -1; }
+  uint8_t c = serialRx.front();
+  serialRx.pop_front();
+  return c;
+}
+
+int HardwareSerial::availableForWrite(void) {
+  return (int)(simSerialTxBuffer - 1) - (int)serialTxQueued();
+}
+
+void HardwareSerial::flush(void) {
+  uint32_t queued = serialTxQueued();
+  if (queued) {
+    uint64_t waitUs = (serialTxDoneNs - simNow * 1000 + 999) / 1000;
+    simStats.serialBlockedUs += waitUs;
+    simAdvance(waitUs);
+  }
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  simAdvance(simCostSerialEnqueue);
+
+  if (serialTxQueued() >= simSerialTxBuffer - 1) {
+    // Wait for the UART to free one slot
+    uint64_t freeAtNs = serialTxDoneNs - (simSerialTxBuffer - 2) * serialByteNs;
+    uint64_t waitUs   = (freeAtNs - simNow * 1000 + 999) / 1000;
+    simStats.serialBlockedUs += waitUs;
+    simAdvance(waitUs);
+  }
+
+  uint64_t nowNs = simNow * 1000;
+  if (serialTxDoneNs < nowNs) { serialTxDoneNs = nowNs; }
+  serialTxDoneNs += serialByteNs;
+
+  simStats.serialBytes++;
+  if (serialOut) { fputc(c, serialOut); }
+  return 1;
+}
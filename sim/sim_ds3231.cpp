@@ -0,0 +1,239 @@
+/*
+ * Register-level DS3231 model, the I2C bus it sits on, and a Wire stand-in
+ */
+
+#include <Wire.h>
+
+#include "sim.h"
+
+/*
+ * DS3231
+ *
+ * Only the time-of-day registers count; the date registers are plain storage (this clock is not
+ * date-aware). Time is derived from the virtual clock on every access, and writing the seconds
+ * register restarts the 1 Hz countdown chain as on the real part. The control register's
+ * INTCN/RS bits select the 1 Hz square wave on SQW (simRtcSqwPin); other rates aren't modelled.
+ * The oscillator can run off the virtual clock's rate by simRtcSetDrift() ppm.
+ */
+
+#define DS3231_ADDRESS 0x68
+#define DS3231_REGS 0x13
+
+#define DS3231_CONTROL 0x0E
+#define DS3231_CONTROL_SQW_MASK 0x1C   // RS2, RS1, INTCN: all clear for a 1 Hz square wave
+
+// Power-on values: 2014-01-01 00:00:00, alarm interrupt mode (no square wave)
+static uint8_t  ds3231Regs[DS3231_REGS] = { 0, 0, 0, 1, 1, 1, 0x14, 0, 0, 0, 0, 0, 0, 0, 0x1C };
+static uint8_t  ds3231Pointer           = 0;
+static uint32_t ds3231BaseSeconds       = 0;   // seconds-of-day at ds3231BaseUs
+static uint64_t ds3231BaseUs            = 0;
+static int32_t  ds3231Ppm               = 0;
+
+// RTC time since ds3231BaseUs, and the virtual time an RTC interval takes (rounded up)
+static uint64_t ds3231ElapsedUs(void) {
+  int64_t us = simNow - ds3231BaseUs;
+  return us + us * ds3231Ppm / 1000000;
+}
+static uint64_t ds3231VirtualUs(uint64_t rtcUs) {
+  return (rtcUs * 1000000 + 1000000 + ds3231Ppm - 1) / (1000000 + ds3231Ppm);
+}
+
+static uint8_t bin2bcd(uint8_t val) { return val + 6 * (val / 10); }
+static uint8_t bcd2bin(uint8_t val) { return val - 6 * (val >> 4); }
+
+static uint32_t ds3231SecondsOfDay(void) {
+  return (uint32_t)((ds3231BaseSeconds + ds3231ElapsedUs() / 1000000) % 86400UL);
+}
+
+// Bring the time registers up to date with the virtual clock
+static void ds3231Sync(void) {
+  uint32_t secs = ds3231SecondsOfDay();
+  ds3231Regs[0] = bin2bcd(secs % 60);
+  ds3231Regs[1] = bin2bcd((secs / 60) % 60);
+  ds3231Regs[2] = bin2bcd(secs / 3600);
+}
+
+/*
+ * SQW output. Each edge schedules the next one; restarting bumps the generation so events from
+ * an earlier phase or setting die out.
+ */
+
+static uint32_t ds3231SqwGeneration = 0;
+
+static void ds3231SqwUpdate(uint32_t generation) {
+  if (generation != ds3231SqwGeneration) { return; }
+
+  bool enabled = (ds3231Regs[DS3231_CONTROL] & DS3231_CONTROL_SQW_MASK) == 0;
+  if (!enabled) {
+    simPullLow(simRtcSqwPin, false);
+    return;
+  }
+
+  // Low for the first half of each second, starting as the seconds register advances
+  uint64_t phase = ds3231ElapsedUs() % 1000000;
+  simPullLow(simRtcSqwPin, phase < 500000);
+  uint64_t next = simNow + ds3231VirtualUs(phase < 500000 ? 500000 - phase : 1000000 - phase);
+  simSchedule(next, [generation]() { ds3231SqwUpdate(generation); });
+}
+
+static void ds3231SqwRestart(void) { ds3231SqwUpdate(++ds3231SqwGeneration); }
+
+// Re-derive the time base after the time registers were written
+static void ds3231Rebase(bool secondsWritten) {
+  ds3231BaseSeconds = bcd2bin(ds3231Regs[2] & 0x3F) * 3600UL + bcd2bin(ds3231Regs[1]) * 60UL +
+                      bcd2bin(ds3231Regs[0] & 0x7F);
+  if (secondsWritten) {
+    ds3231BaseUs = simNow;
+  } else {
+    ds3231BaseUs = simNow - ds3231VirtualUs(ds3231ElapsedUs() % 1000000);
+  }
+}
+
+static void ds3231Write(const uint8_t *data, uint8_t len) {
+  if (len == 0) { return; }
+  ds3231Sync();
+  ds3231Pointer       = data[0];
+  bool timeWritten    = false;
+  bool secondsWritten = false;
+  bool controlWritten = false;
+  for (uint8_t i = 1; i < len; i++) {
+    uint8_t reg = ds3231Pointer % DS3231_REGS;
+    if (reg <= 2) { timeWritten = true; }
+    if (reg == 0) { secondsWritten = true; }
+    if (reg == DS3231_CONTROL) { controlWritten = true; }
+    ds3231Regs[reg] = data[i];
+    ds3231Pointer   = (reg + 1) % DS3231_REGS;
+  }
+  if (timeWritten) { ds3231Rebase(secondsWritten); }
+  if (secondsWritten || controlWritten) { ds3231SqwRestart(); }
+}
+
+static void ds3231Read(uint8_t *data, uint8_t len) {
+  ds3231Sync();
+  for (uint8_t i = 0; i < len; i++) {
+    data[i]       = ds3231Regs[ds3231Pointer];
+    ds3231Pointer = (ds3231Pointer + 1) % DS3231_REGS;
+  }
+}
+
+void simRtcSetTime(uint8_t hour, uint8_t minute, uint8_t second) {
+  ds3231BaseSeconds = hour * 3600UL + minute * 60UL + second;
+  ds3231BaseUs      = simNow;
+  ds3231SqwRestart();
+}
+
+void simRtcSetDrift(int32_t ppm) {
+  // Keep the time and phase so far, at the old rate
+  uint32_t secs = ds3231SecondsOfDay();
+  uint64_t frac = ds3231ElapsedUs() % 1000000;
+
+  ds3231BaseSeconds = secs;
+  ds3231BaseUs      = simNow - ds3231VirtualUs(frac);
+  ds3231Ppm         = ppm;
+}
+
+void simRtcGetTime(uint8_t &hour, uint8_t &minute, uint8_t &second) {
+  uint32_t secs = ds3231SecondsOfDay();
+  hour          = secs / 3600;
+  minute        = (secs / 60) % 60;
+  second        = secs % 60;
+}
+
+void simRtcSetLostPower(bool lost) {
+  if (lost) {
+    ds3231Regs[0x0F] |= 0x80;
+  } else {
+    ds3231Regs[0x0F] &= ~0x80;
+  }
+}
+
+/*
+ * I2C bus
+ */
+
+uint64_t simI2cBusUs(uint32_t clockHz, uint8_t bytes) {
+  return ((uint64_t)(bytes * 9 + 2) * 1000000 + clockHz - 1) / clockHz;
+}
+
+bool simI2cWrite(uint8_t address, const uint8_t *data, uint8_t length) {
+  if (address != DS3231_ADDRESS) { return false; }
+  ds3231Write(data, length);
+  return true;
+}
+
+bool simI2cRead(uint8_t address, uint8_t *data, uint8_t length) {
+  if (address != DS3231_ADDRESS) { return false; }
+  ds3231Read(data, length);
+  return true;
+}
+
+/*
+ * TwoWire - blocks for the whole transfer, like the real library
+ */
+
+TwoWire Wire;
+
+static void wireChargeBus(uint32_t clockHz, uint8_t bytes) {
+  uint64_t us = simI2cBusUs(clockHz, bytes);
+  simStats.i2cTransactions++;
+  simStats.i2cBusUs += us;
+  simAdvance(us);
+}
+
+void TwoWire::begin(void) {
+  rxIndex  = 0;
+  rxLength = 0;
+  txLength = 0;
+}
+
+void TwoWire::setClock(uint32_t clock) { clockHz = clock; }
+
+void TwoWire::beginTransmission(uint8_t address) {
+  txAddress = address;
+  txLength  = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (txLength >= BUFFER_LENGTH) { return 0; }
+  txBuffer[txLength++] = data;
+  return 1;
+}
+
+uint8_t TwoWire::endTransmission(uint8_t sendStop) {
+  (void)sendStop;
+  if (txAddress != DS3231_ADDRESS) {
+    wireChargeBus(clockHz, 1);
+    return 2;   // address send, NACK received
+  }
+  wireChargeBus(clockHz, 1 + txLength);
+  simI2cWrite(txAddress, txBuffer, txLength);
+  txLength = 0;
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop) {
+  (void)sendStop;
+  if (quantity > BUFFER_LENGTH) { quantity = BUFFER_LENGTH; }
+  rxIndex  = 0;
+  rxLength = 0;
+  if (address != DS3231_ADDRESS) {
+    wireChargeBus(clockHz, 1);
+    return 0;
+  }
+  wireChargeBus(clockHz, 1 + quantity);
+  simI2cRead(address, rxBuffer, quantity);
+  rxLength = quantity;
+  return quantity;
+}
+
+int TwoWire::available(void) { return rxLength - rxIndex; }
+
+int TwoWire::read(void) {
+  if (rxIndex >= rxLength) { return -1; }
+  return rxBuffer[rxIndex++];
+}
+
+int TwoWire::peek(void) {
+  if (rxIndex >= rxLength) { return -1; }
+  return rxBuffer[rxIndex];
+}
@@ -0,0 +1,56 @@
+/*
+ * EEPROM stand-in
+ */
+
+#include <EEPROM.h>
+
+#include "sim.h"
+
+EEPROMClass EEPROM;
+
+// Erased cells read back as 0xFF
+static uint8_t eepromCells[E2END + 1];
+static bool    eepromErased = false;
+
+static void eepromInit(void) {
+  if (!eepromErased) {
+    memset(eepromCells, 0xFF, sizeof(eepromCells));
+    eepromErased = true;
+  }
+}
+
+uint8_t EEPROMClass::read(int idx) {
+  eepromInit();
+  simAdvance(simCostEepromRead);
+  return eepromCells[idx & E2END];
+}
+
+void EEPROMClass::write(int idx, uint8_t val) {
+  eepromInit();
+  simAdvance(simCostEepromWrite);
+  simStats.eepromWrites++;
+  simStats.eepromBlockedUs += simCostEepromWrite;
+  eepromCells[idx & E2END] = val;
+}
+
+void EEPROMClass::update(int idx, uint8_t val) {
+  if (read(idx) != val) { write(idx, val); }
+}
+
+bool simEepromLoad(const char *path) {
+  eepromInit();
+  FILE *f = fopen(path, "rb");
+  if (!f) { return false; }
+  size_t n = fread(eepromCells, 1, sizeof(eepromCells), f);
+  fclose(f);
+  return n == sizeof(eepromCells);
+}
+
+bool simEepromSave(const char *path) {
+  eepromInit();
+  FILE *f = fopen(path, "wb");
+  if (!f) { return false; }
+  size_t n = fwrite(eepromCells, 1, sizeof(eepromCells), f);
+  fclose(f);
+  return n == sizeof(eepromCells);
+}
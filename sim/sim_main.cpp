@@ -0,0 +1,243 @@
+/*
+ * Host simulator driver
+ *
+ * Runs the unmodified firmware setup()/loop() against the fakes in sim/include, feeding it
+ * scripted button presses and optionally printing every frame pushed to the strip.
+ *
+ *   tixsim [options]
+ *     --seconds N       simulated run time (default 60)
+ *     --start HH:MM:SS  initial DS3231 time (default 12:00:00)
+ *     --lost-power      start with the DS3231 oscillator-stop flag set
+ *     --rtc-ppm N       run the DS3231 N ppm fast against the MCU's clock (negative: slow)
+ *     --light N         ambient light sensor reading, 0-1023 (default 700, bright)
+ *     --script FILE     scripted input, see below
+ *     --frames          print every frame shown on the strip
+ *     --idle-us N       virtual time skipped between loop() calls, on top of the firmware's
+ *                       own sleep (default 0)
+ *     --serial FILE     write serial output to FILE instead of stdout
+ *     --quiet           discard serial output
+ *     --eeprom FILE     load the EEPROM image from FILE and write it back on exit
+ *
+ * Script lines (times are ms since reset, '#' starts a comment):
+ *     <ms> press <set|up|down> <hold_ms>
+ *     <ms> serial <text>          (bytes for Serial.read(), e.g. "serial p" for the profile)
+ *     <ms> light <0-1023>         (the ambient light sensor's reading from then on)
+ */
+
+#include <Arduino.h>
+#include <getopt.h>
+#include <time.h>
+
+#include <string>
+
+#include "layout.h"
+#include "sim.h"
+
+void setup(void);
+void loop(void);
+
+/*
+ * The strip as the firmware's layout (include/layout.h) has it: the pixel rows with a '|'
+ * between digit groups, after the number of coloured pixels per group (':' between fields)
+ */
+
+static void printFrame(const SimStripState &state) {
+  uint8_t lit[DIGIT_GROUPS] = {};
+  char    rows[LAYOUT_ROWS][LAYOUT_COLS + DIGIT_GROUPS];
+
+  for (uint8_t row = 0; row < LAYOUT_ROWS; row++) {
+    uint8_t out = 0, group = 0;
+    for (uint8_t col = 0; col < LAYOUT_COLS; col++) {
+      if (group + 1 < DIGIT_GROUPS && col == groupFirstCol(group + 1)) {
+        rows[row][out++] = '|';
+        group++;
+      }
+      // Grey pixels are the menus' dim-white background, not part of a digit
+      const uint8_t *p    = &state.pixels[layoutPixel(row, col) * 3];
+      bool           on   = p[0] || p[1] || p[2];
+      bool           grey = on && p[0] == p[1] && p[1] == p[2];
+      if (on && !grey) { lit[group]++; }
+      rows[row][out++] = grey ? 'o' : (on ? '#' : '.');
+    }
+    rows[row][out] = '\0';
+  }
+
+  std::string digits;
+  for (uint8_t g = 0; g < DIGIT_GROUPS; g++) {
+    if (g > 0 && groupDigit(g) / 2 != groupDigit(g - 1) / 2) { digits += ':'; }
+    digits += (char)('0' + lit[g]);
+  }
+
+  printf("[frame %10.3f] %s", simNow / 1e6, digits.c_str());
+  for (uint8_t row = 0; row < LAYOUT_ROWS; row++) { printf("  %s", rows[row]); }
+  printf("\n");
+}
+
+static const uint8_t buttonPins[] = { 9, 7, 8 };   // set, up, down
+
+static int buttonIndex(const char *name) {
+  if (strcmp(name, "set") == 0) { return 0; }
+  if (strcmp(name, "up") == 0) { return 1; }
+  if (strcmp(name, "down") == 0) { return 2; }
+  return -1;
+}
+
+static bool loadScript(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "tixsim: cannot open script %s\n", path);
+    return false;
+  }
+
+  char     line[256];
+  unsigned lineNo = 0;
+  while (fgets(line, sizeof(line), f)) {
+    lineNo++;
+    char *hash = strchr(line, '#');
+    if (hash) { *hash = '\0'; }
+
+    unsigned long at, hold;
+    char          what[16], arg[16];
+    int           n = sscanf(line, "%lu %15s %15s %lu", &at, what, arg, &hold);
+    if (n <= 0) { continue; }
+
+    if (n >= 3 && strcmp(what, "serial") == 0) {
+      std::string text(arg);
+      simSchedule(at * 1000, [text]() { simSerialInput(text.c_str()); });
+      continue;
+    }
+
+    if (n == 3 && strcmp(what, "light") == 0) {
+      uint16_t reading = (uint16_t)constrain(atoi(arg), 0, 1023);
+      simSchedule(at * 1000, [reading]() { simSetLight(reading); });
+      continue;
+    }
+
+    int button = (n == 4 && strcmp(what, "press") == 0) ? buttonIndex(arg) : -1;
+    if (button < 0) {
+      fprintf(stderr, "tixsim: %s:%u: cannot parse '%s'\n", path, lineNo, line);
+      fclose(f);
+      return false;
+    }
+
+    uint8_t pin = buttonPins[button];
+    simSchedule(at * 1000, [pin]() { simPressButton(pin, true); });
+    simSchedule((at + hold) * 1000, [pin]() { simPressButton(pin, false); });
+  }
+
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  double      seconds    = 60;
+  unsigned    idleUs     = 0;
+  bool        frames     = false;
+  bool        lostPower  = false;
+  long        rtcPpm     = 0;
+  long        light      = 700;
+  const char *scriptPath = NULL;
+  const char *eepromPath = NULL;
+  unsigned    startH = 12, startM = 0, startS = 0;
+
+  static const struct option options[] = {
+    { "seconds", required_argument, NULL, 'n' }, { "start", required_argument, NULL, 't' },
+    { "lost-power", no_argument, NULL, 'l' },    { "script", required_argument, NULL, 's' },
+    { "frames", no_argument, NULL, 'f' },        { "idle-us", required_argument, NULL, 'i' },
+    { "serial", required_argument, NULL, 'o' },  { "quiet", no_argument, NULL, 'q' },
+    { "eeprom", required_argument, NULL, 'e' },  { "rtc-ppm", required_argument, NULL, 'p' },
+    { "light", required_argument, NULL, 'a' },   { NULL, 0, NULL, 0 }
+  };
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+    switch (opt) {
+      case 'n':
+        seconds = atof(optarg);
+        break;
+      case 't':
+        if (sscanf(optarg, "%u:%u:%u", &startH, &startM, &startS) != 3 || startH > 23 ||
+            startM > 59 || startS > 59) {
+          fprintf(stderr, "tixsim: bad --start time '%s'\n", optarg);
+          return 2;
+        }
+        break;
+      case 'l':
+        lostPower = true;
+        break;
+      case 'p':
+        rtcPpm = strtol(optarg, NULL, 10);
+        break;
+      case 'a':
+        light = constrain(strtol(optarg, NULL, 10), 0, 1023);
+        break;
+      case 's':
+        scriptPath = optarg;
+        break;
+      case 'f':
+        frames = true;
+        break;
+      case 'i':
+        idleUs = (unsigned)strtoul(optarg, NULL, 10);
+        break;
+      case 'o': {
+        FILE *out = fopen(optarg, "wb");
+        if (!out) {
+          fprintf(stderr, "tixsim: cannot open %s\n", optarg);
+          return 2;
+        }
+        simSerialOutput(out);
+        break;
+      }
+      case 'q':
+        simSerialOutput(NULL);
+        break;
+      case 'e':
+        eepromPath = optarg;
+        break;
+      default:
+        return 2;
+    }
+  }
+
+  simRtcSetTime(startH, startM, startS);
+  simRtcSetLostPower(lostPower);
+  simRtcSetDrift(rtcPpm);
+  simSetLight((uint16_t)light);
+  if (eepromPath) { simEepromLoad(eepromPath); }
+  if (scriptPath && !loadScript(scriptPath)) { return 2; }
+  if (frames) { simOnShow = printFrame; }
+
+  struct timespec wallStart, wallEnd;
+  clock_gettime(CLOCK_MONOTONIC, &wallStart);
+
+  uint64_t endUs = (uint64_t)(seconds * 1e6);
+  setup();
+  while (simNow < endUs) {
+    loop();
+    simStats.loops++;
+    simAdvance(idleUs);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+  fflush(stdout);
+
+  if (eepromPath) { simEepromSave(eepromPath); }
+
+  double wall = (wallEnd.tv_sec - wallStart.tv_sec) + (wallEnd.tv_nsec - wallStart.tv_nsec) / 1e9;
+  uint8_t h, m, s;
+  simRtcGetTime(h, m, s);
+  fprintf(stderr, "simulated %.3f s in %.3f s wall (%.0fx), RTC now %02u:%02u:%02u\n",
+          simNow / 1e6, wall, wall > 0 ? simNow / 1e6 / wall : 0.0, h, m, s);
+  fprintf(stderr, "loops %llu, asleep %.3f s (%.2f%% awake), shows %llu, pixel writes %llu, "
+          "random() %llu, rng %llu\n", (unsigned long long)simStats.loops,
+          simStats.sleptUs / 1e6, simNow ? 100.0 * (simNow - simStats.sleptUs) / simNow : 0.0,
+          (unsigned long long)simStats.shows, (unsigned long long)simStats.pixelWrites,
+          (unsigned long long)simStats.randomCalls, (unsigned long long)simStats.rngDraws);
+  fprintf(stderr, "serial %llu bytes (%llu us blocked), i2c %llu transfers (%llu us), ",
+          (unsigned long long)simStats.serialBytes, (unsigned long long)simStats.serialBlockedUs,
+          (unsigned long long)simStats.i2cTransactions, (unsigned long long)simStats.i2cBusUs);
+  fprintf(stderr, "eeprom %llu writes (%llu us)\n", (unsigned long long)simStats.eepromWrites,
+          (unsigned long long)simStats.eepromBlockedUs);
+  return 0;
+}
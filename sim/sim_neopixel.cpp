@@ -0,0 +1,100 @@
+/*
+ * Adafruit_NeoPixel stand-in
+ */
+
+#include <Adafruit_NeoPixel.h>
+
+#include "sim.h"
+
+std::function<void(const SimStripState &)> simOnShow;
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, uint16_t pin, neoPixelType type)
+    : numLEDs(n), numBytes(n * 3), brightness(0) {
+  (void)pin;
+  pixels  = (uint8_t *)calloc(numBytes, 1);
+  rOffset = (type >> 4) & 0b11;
+  gOffset = (type >> 2) & 0b11;
+  bOffset = type & 0b11;
+}
+
+Adafruit_NeoPixel::~Adafruit_NeoPixel() { free(pixels); }
+
+void Adafruit_NeoPixel::begin(void) {}
+
+void Adafruit_NeoPixel::show(void) {
+  // Interrupts are off for the whole transfer on the board, so this is pure blocking time
+  simAdvance(simCostShowLatch + (uint64_t)simCostShowPerPixel * numLEDs);
+  simStats.shows++;
+
+  if (simOnShow) {
+    SimStripState state = { numLEDs, pixels, rOffset, gOffset, bOffset };
+    simOnShow(state);
+  }
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+  simAdvance(simCostPixelWrite);
+  simStats.pixelWrites++;
+  if (n >= numLEDs) { return; }
+  if (brightness) {   // See notes in setBrightness()
+    r = (r * brightness) >> 8;
+    g = (g * brightness) >> 8;
+    b = (b * brightness) >> 8;
+  }
+  uint8_t *p = &pixels[n * 3];
+  p[rOffset] = r;
+  p[gOffset] = g;
+  p[bOffset] = b;
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t c) {
+  setPixelColor(n, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c);
+}
+
+void Adafruit_NeoPixel::fill(uint32_t c, uint16_t first, uint16_t count) {
+  if (first >= numLEDs) { return; }
+  uint16_t end = (count == 0) ? numLEDs : first + count;
+  if (end > numLEDs) { end = numLEDs; }
+  for (uint16_t i = first; i < end; i++) { setPixelColor(i, c); }
+}
+
+/*
+ * Same arithmetic as the library: brightness is stored as value + 1 so that 0 means "no
+ * scaling", and changing it rescales the existing buffer in place (losing precision).
+ */
+void Adafruit_NeoPixel::setBrightness(uint8_t b) {
+  uint8_t newBrightness = b + 1;
+  if (newBrightness != brightness) {
+    uint8_t  c, *ptr = pixels, oldBrightness = brightness - 1;
+    uint16_t scale;
+    if (oldBrightness == 0) {
+      scale = 0;   // Avoid /0
+    } else if (b == 255) {
+      scale = 65535 / oldBrightness;
+    } else {
+      scale = (((uint16_t)newBrightness << 8) - 1) / oldBrightness;
+    }
+    for (uint16_t i = 0; i < numBytes; i++) {
+      c      = *ptr;
+      *ptr++ = (c * scale) >> 8;
+    }
+    brightness = newBrightness;
+  }
+}
+
+void Adafruit_NeoPixel::clear(void) { memset(pixels, 0, numBytes); }
+
+uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
+  simAdvance(simCostPixelRead);
+  simStats.pixelReads++;
+  if (n >= numLEDs) { return 0; }
+
+  const uint8_t *p = &pixels[n * 3];
+  if (brightness) {
+    simAdvance(3 * simCostDivide32);
+    return (((uint32_t)(p[rOffset] << 8) / brightness) << 16) |
+           (((uint32_t)(p[gOffset] << 8) / brightness) << 8) |
+           ((uint32_t)(p[bOffset] << 8) / brightness);
+  }
+  return ((uint32_t)p[rOffset] << 16) | ((uint32_t)p[gOffset] << 8) | (uint32_t)p[bOffset];
+}
@@ -0,0 +1,33 @@
+/*
+ * The platform part of the firmware's pattern random numbers (include/rng.h) on the simulator
+ *
+ * There's no watchdog oscillator to race, so each timeout is a 16 ms event that samples the
+ * virtual time, charging the interrupt's CPU time. A draw is charged its cycles from the cost
+ * model, carried over to the next one where they don't make a whole microsecond.
+ */
+
+#include "rng.h"
+#include "sim.h"
+
+static uint64_t simNextTimeout;
+static uint32_t rngCycles = 0;   // charged but not yet on the clock
+
+static void timeout(void) {
+  simAdvance(simCostRngTimeout);
+  if (!rngTimeout()) { return; }
+
+  simNextTimeout += 16000;
+  simSchedule(simNextTimeout, timeout);
+}
+
+void rngWatchdogStart(void) {
+  simNextTimeout = simNow + 16000;
+  simSchedule(simNextTimeout, timeout);
+}
+
+void rngDrawn(bool scaled) {
+  rngCycles += scaled ? simCyclesRngBelow : simCyclesRngNext;
+  simAdvance(rngCycles / simCyclesPerUs);
+  rngCycles %= simCyclesPerUs;
+  simStats.rngDraws++;
+}
@@ -0,0 +1,10 @@
+/*
+ * The platform part of the firmware's scheduler (include/sched.h) on the simulator
+ *
+ * Sleeping fast-forwards the virtual clock to the next interrupt.
+ */
+
+#include "sched.h"
+#include "sim.h"
+
+void schedIdle(void) { simSleep(); }
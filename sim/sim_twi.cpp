@@ -0,0 +1,44 @@
+/*
+ * The firmware's TWI engine (include/twi.h) on the simulated I2C bus
+ *
+ * A transaction completes in an event at the time the bus would take, so loop() only pays for
+ * starting it and for the interrupt handler's share of CPU time, which is charged in one lump
+ * when it finishes.
+ */
+
+#include "sim.h"
+#include "twi.h"
+
+static uint32_t twiClockHz = 100000;
+static byte     twiState   = TWI_DONE;
+
+void twiBegin(uint32_t clockHz) { twiClockHz = clockHz; }
+
+byte twiStatus(void) {
+  // Lets a caller spinning on the status see time pass
+  if (twiState == TWI_BUSY) { simAdvance(simCostTwiPoll); }
+  return twiState;
+}
+
+bool twiStart(byte address, const byte *tx, byte txLength, byte *rx, byte rxLength) {
+  if (twiState == TWI_BUSY) { return false; }
+  twiState = TWI_BUSY;
+
+  // Address byte per phase (an empty transaction is an address-only write, to probe); one
+  // interrupt per START and per byte
+  bool     write      = txLength || !rxLength;
+  uint8_t  bytes      = (write ? 1 + txLength : 0) + (rxLength ? 1 + rxLength : 0);
+  uint8_t  interrupts = bytes + (write && rxLength ? 2 : 1);
+  uint64_t us         = simI2cBusUs(twiClockHz, bytes);
+  simStats.i2cTransactions++;
+  simStats.i2cBusUs += us;
+
+  simSchedule(simNow + us, [=]() {
+    bool ok = true;
+    if (write) { ok = simI2cWrite(address, tx, txLength); }
+    if (ok && rxLength) { ok = simI2cRead(address, rx, rxLength); }
+    simAdvance((uint64_t)interrupts * simCostTwiInterrupt);
+    twiState = ok ? TWI_DONE : TWI_ERROR;
+  });
+  return true;
+}
@@ -0,0 +1,74 @@
+/*
+ * Decoder for the firmware's binary telemetry stream (see include/telemetry.h)
+ *
+ *   telemetry_decode [capture]   read a serial capture (default stdin), write CSV to stdout
+ *
+ * The capture may mix telemetry with text log output, e.g. "tixsim --serial capture.bin" from
+ * a TELEMETRY build, or a raw dump of the board's serial port. Frames are found by their sync
+ * byte and kept only if their CRC matches; everything else is skipped. A summary of frames,
+ * bad CRCs and sequence gaps goes to stderr.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "telemetry.h"
+
+// Bitwise CRC-8/CCITT, independent of the firmware's table-driven one
+static uint8_t crc8(const uint8_t *data, size_t length) {
+  uint8_t crc = 0;
+  while (length--) {
+    crc ^= *data++;
+    for (int i = 0; i < 8; i++) { crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : crc << 1; }
+  }
+  return crc;
+}
+
+static unsigned get16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static unsigned bcd(uint8_t v) { return (v >> 4) * 10 + (v & 0x0F); }
+
+int main(int argc, char **argv) {
+  FILE *in = stdin;
+  if (argc > 1 && !(in = fopen(argv[1], "rb"))) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  std::vector<uint8_t> data;
+  uint8_t              chunk[4096];
+  size_t               n;
+  while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) { data.insert(data.end(), chunk, chunk + n); }
+
+  printf("seq,loops,hour,minute,second,rtc_delta_s,rtc_resyncs,shows,eeprom_writes,"
+         "set_clicks,up_clicks,down_clicks,led_ma,led_unlimited_ma,frames_limited\n");
+
+  unsigned long frames = 0, badCrc = 0, gaps = 0;
+  int           lastSeq = -1;
+  for (size_t i = 0; i + TELEMETRY_FRAME_SIZE <= data.size();) {
+    const uint8_t *f = &data[i];
+    if (f[0] != TELEMETRY_SYNC) {
+      i++;
+      continue;
+    }
+    if (crc8(f, TELEMETRY_FRAME_SIZE - 1) != f[TELEMETRY_FRAME_SIZE - 1]) {
+      badCrc++;
+      i++;
+      continue;
+    }
+
+    if (lastSeq >= 0 && f[1] != (uint8_t)(lastSeq + 1)) { gaps++; }
+    lastSeq = f[1];
+    frames++;
+
+    printf("%u,%lu,%u,%u,%u,%d,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", f[1],
+           (unsigned long)get16(f + 2) | ((unsigned long)get16(f + 4) << 16), bcd(f[6]),
+           bcd(f[7]), bcd(f[8]), (int16_t)get16(f + 9), f[11], get16(f + 12), f[14], f[15], f[16],
+           f[17], get16(f + 18), get16(f + 20), f[22]);
+    i += TELEMETRY_FRAME_SIZE;
+  }
+
+  fprintf(stderr, "%lu frames, %lu bad CRC, %lu sequence gaps\n", frames, badCrc, gaps);
+  return 0;
+}
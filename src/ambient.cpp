@@ -0,0 +1,72 @@
+#include "ambient.h"
+
+static_assert(AMBIENT_SAMPLES * 1023UL <= 0xFFFF, "a reading's sum must fit 16 bits");
+
+volatile uint16_t ambientReadings = 0;
+
+static volatile uint16_t ambientAverage = 0;       // in sums of AMBIENT_SAMPLES conversions
+static volatile bool     ambientPrimed  = false;   // has there been a reading yet
+static byte              ambientTarget  = 0;       // brightness followed to
+
+void ambientSample(uint16_t sum) {
+  // The first reading starts the average off where the light is
+  if (!ambientPrimed) {
+    ambientAverage = sum;
+    ambientPrimed  = true;
+  } else {
+    ambientAverage += ((int32_t)sum - ambientAverage) >> AMBIENT_SHIFT;
+  }
+  ambientReadings++;
+}
+
+uint16_t ambientLevel(void) {
+  noInterrupts();
+  uint16_t average = ambientAverage;
+  interrupts();
+  return average / AMBIENT_SAMPLES;
+}
+
+byte ambientBrightness(byte floor, byte ceiling) {
+  // Nothing to go by before the first reading
+  if (!ambientPrimed) { return ceiling; }
+
+  long light  = constrain(ambientLevel(), AMBIENT_DARK, AMBIENT_BRIGHT) - AMBIENT_DARK;
+  byte wanted = floor + (ceiling - floor) * light / (AMBIENT_BRIGHT - AMBIENT_DARK);
+
+  byte target = ambientTarget;
+  if (abs(wanted - target) >= AMBIENT_HYSTERESIS || wanted == floor || wanted == ceiling) {
+    target = wanted;
+  }
+  return constrain(target, floor, ceiling);   // the ceiling may have moved
+}
+
+void ambientUpdate(byte floor, byte ceiling) {
+  if (ambientPrimed) { ambientTarget = ambientBrightness(floor, ceiling); }
+}
+
+#if defined(__AVR__) && defined(AMBIENT_LIGHT)
+
+#include <avr/interrupt.h>
+
+void ambientStart(void) {
+  DIDR0 |= _BV(AMBIENT_PIN);   // no digital input buffer on an analog level
+
+  // AVcc reference, the photoresistor's channel; started by Timer0 overflows, whose millis()
+  // interrupt clears the flag again for the next one; clock / 128 = 125 kHz
+  ADMUX  = _BV(REFS0) | (AMBIENT_PIN & 0x07);
+  ADCSRB = _BV(ADTS2);
+  ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+}
+
+ISR(ADC_vect) {
+  static uint16_t sum   = 0;
+  static byte     count = 0;
+
+  sum += ADC;
+  if (++count < AMBIENT_SAMPLES) { return; }
+  ambientSample(sum);
+  sum   = 0;
+  count = 0;
+}
+
+#endif
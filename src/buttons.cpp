@@ -0,0 +1,184 @@
+#include "buttons.h"
+
+#include "latency.h"
+#include "sched.h"
+
+static_assert((BUTTON_QUEUE_SIZE & (BUTTON_QUEUE_SIZE - 1)) == 0 && BUTTON_QUEUE_SIZE <= 128,
+              "the button queue must be a power of two that byte indices can count past");
+
+// Samples from a raw edge until a period of ms has passed, rounded up
+#define BUTTON_SAMPLES(ms) (((ms) * 1000UL + BUTTON_SAMPLE_US - 1) / BUTTON_SAMPLE_US)
+
+static_assert(BUTTON_SAMPLES(BUTTON_LONG_CLICK) < 255, "the sample count saturates at 255");
+
+int8_t        buttonClicks[BUTTONS];
+unsigned long buttonClickTime[BUTTONS];
+byte          buttonsDropped = 0;
+
+/*
+ * Event queue
+ *
+ * Single producer (the sampling interrupt, which only moves the head) and single consumer
+ * (buttonsPoll(), which only moves the tail), so neither side needs to lock the other out.
+ * The indices run freely and are masked on use, as in the log buffer.
+ */
+
+struct ButtonEvent {
+  unsigned long time;
+  byte          button;
+  int8_t        clicks;
+#ifdef LATENCY_TRACE
+  unsigned long edgeUs;       // micros() of the raw edge that completed it
+  unsigned long acceptedUs;   // and of the sample that accepted that edge
+#endif
+};
+
+static volatile ButtonEvent buttonQueue[BUTTON_QUEUE_SIZE];
+static volatile byte        buttonQueueHead = 0;
+static volatile byte        buttonQueueTail = 0;
+
+#ifdef LATENCY_TRACE
+static unsigned long buttonEdgeUs[BUTTONS];       // of each button's last state change
+static unsigned long buttonAcceptedUs[BUTTONS];
+#endif
+
+static void buttonsPush(byte button, int8_t clicks) {
+  if ((byte)(buttonQueueHead - buttonQueueTail) >= BUTTON_QUEUE_SIZE) {
+    buttonsDropped++;
+    return;
+  }
+
+  volatile ButtonEvent &event = buttonQueue[buttonQueueHead & (BUTTON_QUEUE_SIZE - 1)];
+  event.time                  = millis();
+  event.button                = button;
+  event.clicks                = clicks;
+#ifdef LATENCY_TRACE
+  event.edgeUs     = buttonEdgeUs[button];
+  event.acceptedUs = buttonAcceptedUs[button];
+#endif
+  buttonQueueHead++;
+  schedWake();
+}
+
+void buttonsPoll(void) {
+  memset(buttonClicks, 0, sizeof(buttonClicks));
+
+  while (buttonQueueTail != buttonQueueHead) {
+    volatile ButtonEvent &event = buttonQueue[buttonQueueTail & (BUTTON_QUEUE_SIZE - 1)];
+    byte                  b     = event.button;
+    if (buttonClicks[b]) {
+      schedWake();   // one event per button and pass; the next pass takes this one
+      return;
+    }
+
+    buttonClicks[b]    = event.clicks;
+    buttonClickTime[b] = event.time;
+    LATENCY_HANDLED(event.edgeUs, event.acceptedUs);
+    buttonQueueTail++;
+  }
+}
+
+bool buttonsPending(void) { return buttonQueueTail != buttonQueueHead; }
+
+void buttonsBegin(const byte pins[BUTTONS]) {
+  for (byte b = 0; b < BUTTONS; b++) { pinMode(pins[b], INPUT_PULLUP); }
+  buttonsStart(pins);
+}
+
+/*
+ * Debouncing and click counting, from the sampling interrupt
+ */
+
+static byte buttonState  = 0;      // debounced, bit per button, set while pressed
+static byte buttonCount0 = 0xFF;   // vertical counters: bit b of each is one bit of button b's
+static byte buttonCount1 = 0xFF;   // count, 3 down to 0 and then the state flips
+static byte buttonPresses[BUTTONS];
+static byte buttonSamples[BUTTONS];   // since the last raw edge, saturating
+
+#ifdef LATENCY_TRACE
+static byte          buttonDisagreeing = 0;       // buttons whose samples disagree with their state
+static unsigned long buttonEdgeStart[BUTTONS];   // since when
+
+// Time the raw edge (the first sample of a disagreement) and the acceptance of each change
+static void buttonsTrace(byte disagree, byte changed) {
+  unsigned long now = micros();
+  for (byte b = 0; b < BUTTONS; b++) {
+    byte bit = 1 << b;
+    if ((disagree & bit) && !(buttonDisagreeing & bit)) { buttonEdgeStart[b] = now; }
+    if (changed & bit) {
+      buttonEdgeUs[b]     = buttonEdgeStart[b];
+      buttonAcceptedUs[b] = now;
+    }
+  }
+  buttonDisagreeing = disagree & ~changed;
+}
+#endif
+
+void buttonsSample(byte pressed) {
+  // Count down every button whose sample disagrees with its state; reset all the others
+  byte changed = pressed ^ buttonState;
+#ifdef LATENCY_TRACE
+  byte disagree = changed;
+#endif
+  buttonCount0 = ~(buttonCount0 & changed);
+  buttonCount1 = buttonCount0 ^ (buttonCount1 & changed);
+  changed &= buttonCount0 & buttonCount1;
+  buttonState ^= changed;
+#ifdef LATENCY_TRACE
+  buttonsTrace(disagree, changed);
+#endif
+
+  for (byte b = 0; b < BUTTONS; b++) {
+    byte bit = 1 << b;
+    if (changed & bit) {
+      // The raw edge was the first of the samples that flipped the state
+      buttonSamples[b] = BUTTON_DEBOUNCE_SAMPLES;
+      if ((buttonState & bit) && buttonPresses[b] < 127) { buttonPresses[b]++; }
+    } else if (buttonSamples[b] < 255) {
+      buttonSamples[b]++;
+    }
+
+    if (!buttonPresses[b]) { continue; }
+    if (!(buttonState & bit) && buttonSamples[b] >= BUTTON_SAMPLES(BUTTON_MULTI_CLICK)) {
+      buttonsPush(b, buttonPresses[b]);
+      buttonPresses[b] = 0;
+    } else if ((buttonState & bit) && buttonSamples[b] >= BUTTON_SAMPLES(BUTTON_LONG_CLICK)) {
+      buttonsPush(b, -buttonPresses[b]);
+      buttonPresses[b] = 0;
+    }
+  }
+}
+
+#ifdef __AVR__
+
+#include <avr/interrupt.h>
+
+static volatile uint8_t *buttonPins[BUTTONS];   // input registers
+static byte              buttonMasks[BUTTONS];
+
+void buttonsStart(const byte pins[BUTTONS]) {
+  // The port lookups digitalRead() would do on every call, done once
+  for (byte b = 0; b < BUTTONS; b++) {
+    buttonPins[b]  = portInputRegister(digitalPinToPort(pins[b]));
+    buttonMasks[b] = digitalPinToBitMask(pins[b]);
+  }
+
+  // Timer0 keeps running for millis(); its compare A match is free and comes once per overflow
+  OCR0A = 0x80;
+  TIMSK0 |= _BV(OCIE0A);
+}
+
+ISR(TIMER0_COMPA_vect) {
+  static byte overflows = 0;
+  if (++overflows < BUTTON_SAMPLE_US / 1024) { return; }
+  overflows = 0;
+
+  // Active low
+  byte pressed = 0;
+  for (byte b = 0; b < BUTTONS; b++) {
+    if (!(*buttonPins[b] & buttonMasks[b])) { pressed |= 1 << b; }
+  }
+  buttonsSample(pressed);
+}
+
+#endif
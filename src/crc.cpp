@@ -0,0 +1,58 @@
+#include "crc.h"
+
+// Shift n bits of the register through the polynomial
+constexpr byte crc8Shift(byte crc, byte n) {
+  return n == 0 ? crc
+                : crc8Shift((crc & 0x80) ? (byte)((crc << 1) ^ 0x07) : (byte)(crc << 1), n - 1);
+}
+
+#define CRC8_NIBBLE(i) crc8Shift((i) << 4, 4)
+
+const static byte PROGMEM crc8Nibbles[16] = {
+  CRC8_NIBBLE(0),  CRC8_NIBBLE(1),  CRC8_NIBBLE(2),  CRC8_NIBBLE(3),
+  CRC8_NIBBLE(4),  CRC8_NIBBLE(5),  CRC8_NIBBLE(6),  CRC8_NIBBLE(7),
+  CRC8_NIBBLE(8),  CRC8_NIBBLE(9),  CRC8_NIBBLE(10), CRC8_NIBBLE(11),
+  CRC8_NIBBLE(12), CRC8_NIBBLE(13), CRC8_NIBBLE(14), CRC8_NIBBLE(15),
+};
+
+static_assert(CRC8_NIBBLE(1) == 0x07 && CRC8_NIBBLE(15) == 0x2D && crc8Shift(0xA5, 8) == 0x72,
+              "CRC-8/CCITT steps must match the bitwise definition");
+
+byte crc8Update(byte crc, byte data) {
+  crc ^= data;
+  crc = (byte)(crc << 4) ^ pgm_read_byte(&crc8Nibbles[crc >> 4]);
+  crc = (byte)(crc << 4) ^ pgm_read_byte(&crc8Nibbles[crc >> 4]);
+  return crc;
+}
+
+byte crc8(const byte *data, byte length) {
+  byte crc = 0;
+  while (length--) { crc = crc8Update(crc, *data++); }
+  return crc;
+}
+
+constexpr uint16_t crc16Shift(uint16_t crc, byte n) {
+  return n == 0 ? crc
+                : crc16Shift((crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021)
+                                            : (uint16_t)(crc << 1),
+                             n - 1);
+}
+
+#define CRC16_NIBBLE(i) crc16Shift((i) << 12, 4)
+
+const static uint16_t PROGMEM crc16Nibbles[16] = {
+  CRC16_NIBBLE(0),  CRC16_NIBBLE(1),  CRC16_NIBBLE(2),  CRC16_NIBBLE(3),
+  CRC16_NIBBLE(4),  CRC16_NIBBLE(5),  CRC16_NIBBLE(6),  CRC16_NIBBLE(7),
+  CRC16_NIBBLE(8),  CRC16_NIBBLE(9),  CRC16_NIBBLE(10), CRC16_NIBBLE(11),
+  CRC16_NIBBLE(12), CRC16_NIBBLE(13), CRC16_NIBBLE(14), CRC16_NIBBLE(15),
+};
+
+static_assert(CRC16_NIBBLE(1) == 0x1021 && CRC16_NIBBLE(15) == 0xF1EF,
+              "CRC-16/CCITT steps must match the bitwise definition");
+
+uint16_t crc16Update(uint16_t crc, byte data) {
+  crc ^= (uint16_t)data << 8;
+  crc = (uint16_t)(crc << 4) ^ pgm_read_word(&crc16Nibbles[crc >> 12]);
+  crc = (uint16_t)(crc << 4) ^ pgm_read_word(&crc16Nibbles[crc >> 12]);
+  return crc;
+}
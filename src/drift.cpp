@@ -0,0 +1,37 @@
+#include "drift.h"
+
+long          driftPpm         = 0;
+long          driftLastOffset  = 0;
+long          driftWorstOffset = 0;
+unsigned long driftInterval    = DRIFT_START_INTERVAL;
+unsigned int  driftResyncs     = 0;
+
+static long driftOwed = 0;   // us of drift not yet taken out of a tick
+
+unsigned int driftTick(void) {
+  driftOwed += driftPpm;
+  long ms = driftOwed / 1000;
+  driftOwed -= ms * 1000;
+  return 1000 + ms;
+}
+
+void driftMeasured(long offsetMs, unsigned long elapsedMs) {
+  driftLastOffset = offsetMs;
+  if (labs(offsetMs) > labs(driftWorstOffset)) { driftWorstOffset = offsetMs; }
+
+  // What the estimate missed by over this period; the first measurement goes in whole, later
+  // ones half at a time to smooth out the few ms each one can be off by
+  unsigned long seconds = elapsedMs / 1000;
+  if (seconds > 0) {
+    long missed = offsetMs * 1000 / (long)seconds;
+    driftPpm += driftResyncs == 0 ? missed : missed / 2;
+    driftPpm = constrain(driftPpm, -DRIFT_MAX_PPM, DRIFT_MAX_PPM);
+  }
+  driftResyncs++;
+
+  if (labs(offsetMs) <= DRIFT_STEADY && driftInterval < DRIFT_MAX_INTERVAL) {
+    driftInterval *= 2;
+  } else if (labs(offsetMs) > DRIFT_UNSTEADY && driftInterval > DRIFT_MIN_INTERVAL) {
+    driftInterval /= 2;
+  }
+}
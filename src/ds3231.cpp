@@ -0,0 +1,187 @@
+#include "ds3231.h"
+
+#include "bcd.h"
+#include "sched.h"
+#include "twi.h"
+
+#define DS3231_REG_SECONDS 0x00
+#define DS3231_REG_CONTROL 0x0E
+#define DS3231_REG_STATUS 0x0F
+
+#define DS3231_HOUR_12H 0x40        // 12-hour mode bit of the hours register
+#define DS3231_HOUR_PM 0x20         // PM bit, in 12-hour mode
+#define DS3231_CONTROL_RS 0x18      // square wave rate select (00 = 1 Hz)
+#define DS3231_CONTROL_INTCN 0x04   // SQW/INT pin: 1 = alarm interrupt, 0 = square wave
+#define DS3231_STATUS_OSF 0x80      // oscillator stop flag
+
+static volatile byte ticks = 0;
+
+static byte readRegister(byte reg) {
+  byte value = 0;
+  twiTransfer(DS3231_ADDRESS, &reg, 1, &value, 1);
+  return value;
+}
+
+static void writeRegister(byte reg, byte value) {
+  const byte tx[] = { reg, value };
+  twiTransfer(DS3231_ADDRESS, tx, sizeof(tx), NULL, 0);
+}
+
+// Seconds, minutes, hours registers to BcdTime
+static void decodeTime(const byte *regs, BcdTime &time) {
+  time.second = regs[0] & 0x7F;
+  time.minute = regs[1] & 0x7F;
+
+  byte hour = regs[2];
+  if (hour & DS3231_HOUR_12H) {
+    // Set by something else; 12 AM is 00, 12 PM stays 12, the rest of PM adds 12
+    byte h12 = hour & 0x1F;
+    bool pm  = hour & DS3231_HOUR_PM;
+    hour     = (h12 == 0x12) ? 0x00 : h12;
+    if (pm) {
+      hour += 0x12;
+      if (bcdOnes(hour) > 9) { hour += 0x06; }
+    }
+  } else {
+    hour &= 0x3F;
+  }
+  time.hour = hour;
+}
+
+// Register pointer followed by the seconds, minutes, hours registers
+static void encodeTime(const BcdTime &time, byte *tx) {
+  tx[0] = DS3231_REG_SECONDS;
+  tx[1] = time.second;
+  tx[2] = time.minute;
+  tx[3] = time.hour;   // 12-hour bit clear: 24-hour mode
+}
+
+bool ds3231Begin(void) {
+  twiBegin(DS3231_I2C_CLOCK);
+  return twiTransfer(DS3231_ADDRESS, NULL, 0, NULL, 0) == TWI_DONE;
+}
+
+bool ds3231LostPower(void) { return readRegister(DS3231_REG_STATUS) & DS3231_STATUS_OSF; }
+
+void ds3231ReadTime(BcdTime &time) {
+  const byte reg = DS3231_REG_SECONDS;
+  byte       regs[3];
+  twiTransfer(DS3231_ADDRESS, &reg, 1, regs, sizeof(regs));
+  decodeTime(regs, time);
+}
+
+void ds3231WriteTime(const BcdTime &time) {
+  byte tx[4];
+  encodeTime(time, tx);
+  twiTransfer(DS3231_ADDRESS, tx, sizeof(tx), NULL, 0);
+  ticks = 0;   // writing the seconds restarts the 1 Hz countdown; earlier ticks are stale
+
+  writeRegister(DS3231_REG_STATUS, readRegister(DS3231_REG_STATUS) & ~DS3231_STATUS_OSF);
+}
+
+/*
+ * Background transfers
+ *
+ * At most one transaction is on the bus. A queued write goes out before a requested read, so
+ * the read sees the new time, and it throws away any read already under way or delivered.
+ */
+
+enum RtcTransfer
+{
+  RTC_IDLE,
+  RTC_READING,
+  RTC_WRITING,
+};
+
+static byte    rtcTransfer     = RTC_IDLE;
+static bool    rtcReadWanted   = false;
+static bool    rtcReadReady    = false;
+static bool    rtcWriteWanted  = false;
+static BcdTime rtcWriteTime;
+static byte    rtcTx[4];
+static byte    rtcRx[3];
+
+void ds3231Update(void) {
+  if (rtcTransfer != RTC_IDLE) {
+    byte status = twiStatus();
+    if (status == TWI_BUSY) { return; }
+
+    // A failed read is simply not delivered; the caller asks again on its next interval
+    if (rtcTransfer == RTC_READING) {
+      rtcReadReady = (status == TWI_DONE) && !rtcWriteWanted;
+    } else if (status == TWI_DONE) {
+      ticks = 0;
+    } else {
+      rtcWriteWanted = true;   // retry: a lost set is worse than a late one
+    }
+    rtcTransfer = RTC_IDLE;
+  }
+
+  if (rtcWriteWanted) {
+    encodeTime(rtcWriteTime, rtcTx);
+    if (twiStart(DS3231_ADDRESS, rtcTx, sizeof(rtcTx), NULL, 0)) {
+      rtcWriteWanted = false;
+      rtcTransfer    = RTC_WRITING;
+    }
+  } else if (rtcReadWanted) {
+    rtcTx[0] = DS3231_REG_SECONDS;
+    if (twiStart(DS3231_ADDRESS, rtcTx, 1, rtcRx, sizeof(rtcRx))) {
+      rtcReadWanted = false;
+      rtcTransfer   = RTC_READING;
+    }
+  }
+
+  // Poll for the end of the transfer (or the chance to start it) on the next ms
+  if (rtcTransfer != RTC_IDLE || rtcWriteWanted || rtcReadWanted) { schedAt(millis() + 1); }
+}
+
+bool ds3231RequestTime(void) {
+  if (rtcReadWanted || rtcTransfer == RTC_READING) { return false; }
+  rtcReadWanted = true;
+  rtcReadReady  = false;
+  ds3231Update();
+  return true;
+}
+
+bool ds3231TimeReady(BcdTime &time) {
+  if (!rtcReadReady) { return false; }
+  rtcReadReady = false;
+  decodeTime(rtcRx, time);
+  return true;
+}
+
+void ds3231QueueTime(const BcdTime &time) {
+  rtcWriteTime   = time;
+  rtcWriteWanted = true;
+  rtcReadReady   = false;
+  ds3231Update();
+}
+
+/*
+ * 1 Hz ticks
+ */
+
+static void countTick(void) {
+  ticks++;
+  schedWake();
+}
+
+void ds3231StartTicks(byte pin) {
+  writeRegister(DS3231_REG_CONTROL, readRegister(DS3231_REG_CONTROL) &
+                                        ~(DS3231_CONTROL_RS | DS3231_CONTROL_INTCN));
+
+  pinMode(pin, INPUT_PULLUP);
+  ticks = 0;
+  attachInterrupt(digitalPinToInterrupt(pin), countTick, FALLING);
+}
+
+byte ds3231TakeTicks(void) {
+  // Until a queued time is in the chip, ticks still belong to the old seconds countdown
+  if (rtcWriteWanted || rtcTransfer == RTC_WRITING) { return 0; }
+
+  noInterrupts();
+  byte taken = ticks;
+  ticks      = 0;
+  interrupts();
+  return taken;
+}
@@ -0,0 +1,136 @@
+#include "fade.h"
+
+#ifdef CROSSFADE
+
+#include "buttons.h"
+#include "frame.h"
+#include "power.h"
+#include "sched.h"
+#include "tables.h"
+
+uint16_t fadesStarted     = 0;
+uint32_t fadeStepsShown   = 0;
+uint32_t fadeStepsDropped = 0;
+uint32_t fadeStepsHeld    = 0;
+uint16_t fadeStepUs       = 0;
+
+static byte          fadeFrom[LAYOUT_PIXELS * 3];   // the pixels shown when the fade began
+static byte          fadeTo[LAYOUT_PIXELS * 3];     // the frame it ends on
+static bool          fadeRunning = false;
+static byte          fadeStep    = 0;   // steps shown so far of this fade
+static unsigned long fadeStart   = 0;   // millis() the fade began
+static uint32_t      fadeMs      = 0;   // ms spent fading, over all fades
+
+/*
+ * Step weights, generated at compile time
+ */
+
+// Smoothstep 3t^2 - 2t^3 at t = step / FADE_STEPS, in 8.8 fixed point (256 = 1.0), rounded
+constexpr uint16_t fadeWeight(byte step) {
+  return (256UL * step * step * (3UL * FADE_STEPS - 2UL * step) +
+          (unsigned long)FADE_STEPS * FADE_STEPS * FADE_STEPS / 2) /
+         ((unsigned long)FADE_STEPS * FADE_STEPS * FADE_STEPS);
+}
+
+template <typename Seq>
+struct FadeTables;
+template <byte... Is>
+struct FadeTables<IndexSeq<Is...> > {
+  static const uint16_t PROGMEM weight[sizeof...(Is)];   // weight of step Is + 1
+};
+template <byte... Is>
+const uint16_t PROGMEM FadeTables<IndexSeq<Is...> >::weight[sizeof...(Is)] = {
+  fadeWeight(Is + 1)...
+};
+
+typedef FadeTables<MakeIndexSeq<FADE_STEPS>::type> Fade;
+
+static_assert(FADE_STEPS >= 2 && FADE_STEPS <= 64, "FADE_STEPS out of range");
+static_assert(fadeWeight(FADE_STEPS) == 256, "a fade must end exactly on the new frame");
+
+/*
+ * Fading
+ */
+
+// Write step 'step' (1 to FADE_STEPS) into the strip's buffer; the blend of two bytes in 8.8
+// fixed point stays within 16 bits (255 * 256 at most), and is exact at both ends
+static void blend(byte *pixels, byte step) {
+  uint16_t to   = pgm_read_word(&Fade::weight[step - 1]);
+  uint16_t from = 256 - to;
+  uint16_t load = 0;
+  for (byte i = 0; i < sizeof(fadeTo); i++) {
+    pixels[i] = (fadeFrom[i] * from + fadeTo[i] * to) >> 8;
+    load += pixels[i];
+  }
+  powerLimit(pixels, load);   // between two frames within the budget, only the estimate
+}
+
+static void fadeEnd(void) {
+  fadeMs += millis() - fadeStart;
+  fadeRunning = false;
+}
+
+bool fadeShow(Adafruit_NeoPixel &strip) {
+  byte *pixels = strip.getPixels();
+  if (memcmp(pixels, frameShownPixels(), sizeof(fadeTo)) == 0) {
+    return frameShow(strip);   // counted as skipped
+  }
+
+  // From whatever is on the LEDs, which may be part way through the last fade
+  memcpy(fadeFrom, frameShownPixels(), sizeof(fadeFrom));
+  memcpy(fadeTo, pixels, sizeof(fadeTo));
+  fadeRunning = true;
+  fadeStep    = 0;
+  fadeStart   = millis();
+  fadesStarted++;
+
+  fadeTick(strip);
+  return true;
+}
+
+void fadeTick(Adafruit_NeoPixel &strip) {
+  if (!fadeRunning) { return; }
+
+  unsigned long elapsed = millis() - fadeStart;
+  unsigned long due     = elapsed / FADE_STEP_MS;
+  if (due > FADE_STEPS) { due = FADE_STEPS; }
+
+  if (due > fadeStep) {
+    // Held back for button events, or for a deadline closer than a step takes; never past
+    // the end of the fade plus a step
+    long slackUs = ((long)(schedNext() - millis()) - 1) * 1000;
+    bool late    = elapsed >= (FADE_STEPS + 1) * (unsigned long)FADE_STEP_MS;
+    if (!late && (buttonsPending() || slackUs < (long)fadeStepUs)) {
+      fadeStepsHeld++;
+      schedAt(millis() + 1);
+      return;
+    }
+
+    unsigned long start = micros();
+    blend(strip.getPixels(), due);
+    frameShow(strip);
+    unsigned long us = micros() - start;
+    fadeStepUs       = us > fadeStepUs ? (us > 0xFFFF ? 0xFFFF : us) : fadeStepUs;
+
+    fadeStepsDropped += due - fadeStep - 1;
+    fadeStepsShown++;
+    fadeStep = due;
+    if (fadeStep == FADE_STEPS) {
+      fadeEnd();
+      return;
+    }
+  }
+
+  schedAt(fadeStart + (fadeStep + 1) * (unsigned long)FADE_STEP_MS);
+}
+
+void fadeStop(void) {
+  if (fadeRunning) { fadeEnd(); }
+}
+
+uint16_t fadeFps(void) {
+  uint32_t ms = fadeMs + (fadeRunning ? millis() - fadeStart : 0);
+  return ms ? fadeStepsShown * 1000 / ms : 0;
+}
+
+#endif
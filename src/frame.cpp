@@ -0,0 +1,167 @@
+#include "frame.h"
+
+#include "bcd.h"
+#include "fade.h"
+#include "latency.h"
+#include "palette.h"
+#include "pattern.h"
+#include "power.h"
+#include "tables.h"
+
+FrameBits frameLit = 0;
+
+static Frame lastFrame = {};   // all off
+
+/*
+ * Per-pixel and per-group lookup tables, generated from the layout at compile time
+ */
+
+template <typename Seq>
+struct PixelTables;
+template <byte... Is>
+struct PixelTables<IndexSeq<Is...> > {
+  static const byte PROGMEM      group[sizeof...(Is)];   // digit group of each strip pixel
+  static const FrameBits PROGMEM mask[sizeof...(Is)];    // frame bit of each strip pixel
+};
+template <byte... Is>
+const byte PROGMEM PixelTables<IndexSeq<Is...> >::group[sizeof...(Is)] = { pixelGroup(Is)... };
+template <byte... Is>
+const FrameBits PROGMEM PixelTables<IndexSeq<Is...> >::mask[sizeof...(Is)] = { pixelMask(Is)... };
+
+typedef PixelTables<MakeIndexSeq<LAYOUT_PIXELS>::type> Pixels;
+
+template <typename Seq>
+struct GroupTables;
+template <byte... Is>
+struct GroupTables<IndexSeq<Is...> > {
+  static const byte PROGMEM firstBit[sizeof...(Is)];   // groupFirstBit() of each group
+  static const byte PROGMEM size[sizeof...(Is)];       // groupSize()
+  static const byte PROGMEM digit[sizeof...(Is)];      // groupDigit()
+};
+template <byte... Is>
+const byte PROGMEM GroupTables<IndexSeq<Is...> >::firstBit[sizeof...(Is)] = {
+  groupFirstBit(Is)...
+};
+template <byte... Is>
+const byte PROGMEM GroupTables<IndexSeq<Is...> >::size[sizeof...(Is)] = { groupSize(Is)... };
+template <byte... Is>
+const byte PROGMEM GroupTables<IndexSeq<Is...> >::digit[sizeof...(Is)] = { groupDigit(Is)... };
+
+typedef GroupTables<MakeIndexSeq<DIGIT_GROUPS>::type> Groups;
+
+static inline uint32_t readMask(const uint32_t *mask) { return pgm_read_dword(mask); }
+static inline uint64_t readMask(const uint64_t *mask) {
+  const uint32_t *half = (const uint32_t *)mask;
+  return pgm_read_dword(&half[0]) | (uint64_t)pgm_read_dword(&half[1]) << 32;
+}
+
+// Every group must be able to show its largest value, and fit a pattern (pattern.h)
+constexpr bool groupsFit(byte group = 0) {
+  return group == DIGIT_GROUPS || (groupMax(group) <= groupSize(group) &&
+                                   groupSize(group) <= PATTERN_MAX_LEDS && groupsFit(group + 1));
+}
+static_assert(groupsFit(), "a digit group is too small for its digit or too big for a pattern");
+
+#ifndef LAYOUT_SECONDS
+static_assert(groupPixel(HOUR_ONES, 3) == 16 && groupPixel(MINUTE_ONES, 5) == 9 &&
+                  groupPixel(MINUTE_TENS, 4) == 22,
+              "layout formulas must match the wiring diagram");
+#endif
+
+/*
+ * Digit patterns
+ */
+
+byte frameTimeDigit(byte group, const byte time[3]) {
+  byte digit = pgm_read_byte(&Groups::digit[group]);
+  byte bcd   = time[digit >> 1];
+  return (digit & 1) ? bcdOnes(bcd) : bcdTens(bcd);
+}
+
+static FrameBits bits(byte group, uint16_t pattern) {
+  return (FrameBits)pattern << pgm_read_byte(&Groups::firstBit[group]);
+}
+
+FrameBits frameDigit(byte group, byte digit) { return bits(group, (1U << digit) - 1); }
+
+FrameBits frameGroup(byte group) {
+  return frameDigit(group, pgm_read_byte(&Groups::size[group]));
+}
+
+FrameBits frameRandomDigit(byte group, byte digit) {
+  byte     size     = pgm_read_byte(&Groups::size[group]);
+  uint16_t previous = (frameLit >> pgm_read_byte(&Groups::firstBit[group])) & ((1U << size) - 1);
+  return bits(group, patternNext(size, digit, previous));
+}
+
+/*
+ * Rendering
+ */
+
+void frameRender(const Frame &frame, byte *pixels) {
+  byte    *out  = pixels;
+  uint16_t load = 0;   // channel values written, for the current estimate
+
+  // One pass over the strip in wire order
+  for (byte i = 0; i < LAYOUT_PIXELS; i++) {
+    byte        g     = pgm_read_byte(&Pixels::group[i]);
+    FrameBits   mask  = readMask(&Pixels::mask[i]);
+    byte        color = (frame.lit & mask) ? frame.color[g] : frame.unlit[g];
+    const byte *rgb   = paletteCache[color];
+    *out++            = rgb[0];
+    *out++            = rgb[1];
+    *out++            = rgb[2];
+    load += paletteLoad[color];
+  }
+  powerLimit(pixels, load);
+
+  frameLit  = frame.lit;
+  lastFrame = frame;
+  FADE_STOP();
+}
+
+void frameRefresh(byte *pixels) { frameRender(lastFrame, pixels); }
+
+void frameClear(byte *pixels) {
+  memset(pixels, 0, LAYOUT_PIXELS * 3);
+  powerLimit(pixels, 0);
+  frameLit  = 0;
+  lastFrame = Frame();
+  FADE_STOP();
+}
+
+/*
+ * Showing
+ */
+
+uint32_t frameShowsIssued  = 0;
+uint32_t frameShowsSkipped = 0;
+
+static byte shadowPixels[LAYOUT_PIXELS * 3];
+static bool shadowValid = false;   // nothing has been shown yet
+
+bool frameShow(Adafruit_NeoPixel &strip) {
+  const byte *pixels = strip.getPixels();
+  bool        dirty  = !shadowValid;
+
+  // Compare and copy in the same pass; once dirty the rest is only copied
+  for (byte i = 0; i < sizeof(shadowPixels); i++) {
+    if (shadowPixels[i] != pixels[i]) {
+      dirty           = true;
+      shadowPixels[i] = pixels[i];
+    }
+  }
+
+  if (!dirty) {
+    frameShowsSkipped++;
+    return false;
+  }
+
+  shadowValid = true;
+  strip.show();
+  frameShowsIssued++;
+  LATENCY_SHOWN();
+  return true;
+}
+
+const byte *frameShownPixels(void) { return shadowPixels; }
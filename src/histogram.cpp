@@ -0,0 +1,62 @@
+#include "histogram.h"
+
+void histogramRecord(Histogram &h, unsigned long us) {
+  // log2 bucket, counting from 8 us. Typical loop() passes take 2-4 iterations here.
+  byte          bucket = 0;
+  unsigned long v      = us >> 3;
+  while (v && bucket < HISTOGRAM_BUCKETS - 1) {
+    bucket++;
+    v >>= 1;
+  }
+
+  if (h.buckets[bucket] == 0xFFFF) {
+    // Round up so rare slow values don't vanish from the tail
+    for (byte i = 0; i < HISTOGRAM_BUCKETS; i++) { h.buckets[i] = (h.buckets[i] + 1) >> 1; }
+  }
+  h.buckets[bucket]++;
+
+  if (h.count == 0 || us < h.min) { h.min = us; }
+  if (us > h.max) { h.max = us; }
+  h.count++;
+}
+
+/*
+ * p99 from the histogram: upper edge of the bucket where the cumulative count passes 99%,
+ * clamped to the observed max
+ */
+static unsigned long histogramP99(const Histogram &h) {
+  unsigned long total = 0;
+  for (byte i = 0; i < HISTOGRAM_BUCKETS; i++) { total += h.buckets[i]; }
+
+  unsigned long threshold = total - total / 100;
+  unsigned long running   = 0;
+  for (byte i = 0; i < HISTOGRAM_BUCKETS - 1; i++) {
+    running += h.buckets[i];
+    if (running >= threshold) {
+      unsigned long edge = (8UL << i) - 1;
+      return edge < h.max ? edge : h.max;
+    }
+  }
+  return h.max;
+}
+
+void histogramPrint(const Histogram &h) {
+  Serial.print(F(", "));
+  Serial.print(h.count);
+  Serial.print(F(", "));
+  Serial.print(h.min);
+  Serial.print(F(", "));
+  Serial.print(h.max);
+  Serial.print(F(", "));
+  Serial.print(histogramP99(h));
+  Serial.print(F(","));
+
+  // Trailing empty buckets are left out
+  byte last = HISTOGRAM_BUCKETS;
+  while (last > 0 && h.buckets[last - 1] == 0) { last--; }
+  for (byte i = 0; i < last; i++) {
+    Serial.print(' ');
+    Serial.print(h.buckets[i]);
+  }
+  Serial.println();
+}
@@ -0,0 +1,77 @@
+#include "latency.h"
+
+#ifdef LATENCY_TRACE
+
+#include "histogram.h"
+
+enum LatencyStage
+{
+  STAGE_DEBOUNCE,
+  STAGE_CLICK,
+  STAGE_RENDER,
+  STAGE_TOTAL
+};
+
+static Histogram     latency[LATENCY_STAGES];
+static unsigned long latencyUnshown = 0;   // events nothing was shown for
+
+// The event taken this pass, if any
+static bool          latencyPending = false;
+static unsigned long latencyEdge, latencyAccepted, latencyTaken;
+
+const char latencyName0[] PROGMEM = "debounce";
+const char latencyName1[] PROGMEM = "click";
+const char latencyName2[] PROGMEM = "render";
+const char latencyName3[] PROGMEM = "total";
+
+const char *const latencyNames[LATENCY_STAGES] PROGMEM = {
+  latencyName0, latencyName1, latencyName2, latencyName3,
+};
+
+void latencyHandled(unsigned long edgeUs, unsigned long acceptedUs) {
+  // Only the first event of a pass is followed; the show() can't be told apart
+  if (latencyPending) { return; }
+  latencyPending  = true;
+  latencyEdge     = edgeUs;
+  latencyAccepted = acceptedUs;
+  latencyTaken    = micros();
+}
+
+void latencyShown(void) {
+  if (!latencyPending) { return; }
+  latencyPending = false;
+
+  unsigned long now = micros();
+  histogramRecord(latency[STAGE_DEBOUNCE], latencyAccepted - latencyEdge);
+  histogramRecord(latency[STAGE_CLICK], latencyTaken - latencyAccepted);
+  histogramRecord(latency[STAGE_RENDER], now - latencyTaken);
+  histogramRecord(latency[STAGE_TOTAL], now - latencyEdge);
+}
+
+void latencyPassEnd(void) {
+  if (latencyPending) {
+    latencyPending = false;
+    latencyUnshown++;
+  }
+}
+
+void latencyReset(void) {
+  memset(latency, 0, sizeof(latency));
+  latencyUnshown = 0;
+}
+
+void latencyDump(void) {
+  Serial.println(F("Button latency (us): stage, count, min, max, p99, buckets from <8 us"));
+
+  for (byte s = 0; s < LATENCY_STAGES; s++) {
+    if (latency[s].count == 0) { continue; }
+
+    Serial.print((const __FlashStringHelper *)pgm_read_ptr(&latencyNames[s]));
+    histogramPrint(latency[s]);
+  }
+
+  Serial.print(F("Events with nothing shown: "));
+  Serial.println(latencyUnshown);
+}
+
+#endif
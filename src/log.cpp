@@ -0,0 +1,76 @@
+#include "log.h"
+
+#include "sched.h"
+
+static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0 && LOG_BUFFER_SIZE <= 128,
+              "the log buffer must be a power of two that byte indices can count past");
+
+LogBuffer     logBuffer;
+unsigned long logDropped = 0;
+
+Logger<(LOG_LEVEL >= LOG_LEVEL_ERROR)> logError;
+Logger<(LOG_LEVEL >= LOG_LEVEL_WARN)>  logWarn;
+Logger<(LOG_LEVEL >= LOG_LEVEL_INFO)>  logInfo;
+Logger<(LOG_LEVEL >= LOG_LEVEL_DEBUG)> logDebug;
+
+/*
+ * Ring buffer
+ *
+ * The indices run freely through 0-255 and are masked on use, so head - tail is the fill level
+ * even after wrapping. Bytes between tail and committed are complete messages ready to send;
+ * bytes from committed to head belong to the message still being written.
+ */
+
+static byte logRing[LOG_BUFFER_SIZE];
+static byte logHead      = 0;
+static byte logCommitted = 0;
+static byte logTail      = 0;
+static bool logDropping  = false;   // rest of the current message is being discarded
+
+size_t LogBuffer::write(uint8_t c) {
+  if (logDropping) {
+    if (c == '\n') { logDropping = false; }
+    return 0;
+  }
+
+  if ((byte)(logHead - logTail) >= LOG_BUFFER_SIZE) {
+    // Full: take back what this message already queued and skip to its end
+    logHead     = logCommitted;
+    logDropping = (c != '\n');
+    logDropped++;
+    return 0;
+  }
+
+  logRing[logHead++ & (LOG_BUFFER_SIZE - 1)] = c;
+  if (c == '\n') {
+    logCommitted = logHead;
+    schedWake();   // have the next pass send it rather than whenever that would have been
+  }
+  return 1;
+}
+
+bool logWriteRaw(const byte *data, byte length) {
+  // Not in the middle of a text message, and room for the whole block
+  if (logHead != logCommitted || length > LOG_BUFFER_SIZE - (byte)(logHead - logTail)) {
+    logDropped++;
+    return false;
+  }
+
+  while (length--) { logRing[logHead++ & (LOG_BUFFER_SIZE - 1)] = *data++; }
+  logCommitted = logHead;
+  schedWake();
+  return true;
+}
+
+void logDrain(void) {
+  while (logTail != logCommitted && Serial.availableForWrite() > 0) {
+    Serial.write(logRing[logTail++ & (LOG_BUFFER_SIZE - 1)]);
+  }
+
+  // The UART frees a byte every 87 us at 115200 baud, so the rest can go next ms
+  if (logTail != logCommitted) { schedAt(millis() + 1); }
+}
+
+void logFlush(void) {
+  while (logTail != logCommitted) { Serial.write(logRing[logTail++ & (LOG_BUFFER_SIZE - 1)]); }
+}
@@ -1,12 +1,30 @@
 #include <Adafruit_NeoPixel.h>
 #include <Arduino.h>
-#include <ClickButton.h>
-#include <EEPROM.h>
-#include <RTClib.h>
+
+#include "ambient.h"
+#include "bcd.h"
+#include "buttons.h"
+#include "drift.h"
+#include "ds3231.h"
+#include "fade.h"
+#include "frame.h"
+#include "latency.h"
+#include "log.h"
+#include "menu.h"
+#include "palette.h"
+#include "power.h"
+#include "profiler.h"
+#include "rng.h"
+#include "sched.h"
+#include "settings.h"
+#include "store.h"
+#include "telemetry.h"
 
 /*
  * Official TIX menu functions:
  *
+ * At power-up the version shows for 3 seconds (new: hold any button to skip it)
+ *
  * Hold 'Set' to set time (in original it was a short press)
  * - Left 2 indicators flash. Use up/down to set from 1 to 12.
  * - Press again, tens-of-minutes flash. Up/down to set from 1-5.
@@ -15,6 +33,8 @@
  *
  * Changing brightness:
  * - In normal mode, press 'Up' to cycle through brightness levels.
+ * - New: with a light sensor (AMBIENT_LIGHT builds, see ambient.h) that sets the brightness for
+ *   a bright room, and the display dims toward the lowest level as the room gets dark.
  *
  * Setting update rate:
  * - Hold 'Up' for 2 seconds (in original this was 'Set'). All indicators go out except one of
@@ -23,6 +43,7 @@
  * - Middle LED  = 4s (default)
  * - Bottom LED  = 1m
  * - Press 'Set' or long press 'Up' to return
+ * - New: in CROSSFADE builds (see fade.h) each new pattern fades in over 400 ms
  *
  * New: Setting color pattern
  * - Hold 'Down' for 2 seconds (in original this did nothing)
@@ -42,7 +63,6 @@
 
 // Using a ChronoDot from Adafruit - DS3231 based
 // Besides power, connect SDA to A4, and SCL to A5
-RTC_DS3231 rtc;
 
 /*
  * Software version
@@ -51,6 +71,10 @@ RTC_DS3231 rtc;
 #define VER_MAJ 1
 #define VER_MIN 1
 
+// The version splash at power-up, then a blank display before the clock starts
+#define SPLASH_SHOW 3000   // ms
+#define SPLASH_GAP 500     // ms
+
 /*
  * Intialize buttons
  */
@@ -59,9 +83,25 @@ RTC_DS3231 rtc;
 #define BTN_DOWN 8
 #define BTN_SET 9
 
-ClickButton setButton(BTN_SET, LOW, CLICKBTN_PULLUP);
-ClickButton upButton(BTN_UP, LOW, CLICKBTN_PULLUP);
-ClickButton downButton(BTN_DOWN, LOW, CLICKBTN_PULLUP);
+const byte buttonPins[BUTTONS] = { BTN_SET, BTN_UP, BTN_DOWN };   // in Button order
+
+/*
+ * RTC
+ *
+ * Build with -DRTC_SQW to count seconds from the DS3231's 1 Hz SQW output (wire SQW to
+ * RTC_SQW_PIN) instead of timing them with millis() and resyncing from the RTC every
+ * driftInterval (see drift.h).
+ *
+ * A resync is timed at the edge where the RTC's seconds advance: from RESYNC_GUARD before the
+ * tick that edge is expected at, the time is read in the background every RESYNC_POLL until the
+ * seconds change. The edge came between the last two reads, which puts the correction to within
+ * a few ms. Without an edge for RESYNC_GIVE_UP the time is taken as it is.
+ */
+
+#define RTC_SQW_PIN 2         // must be an external interrupt pin (2 or 3)
+#define RESYNC_POLL 5         // ms between reads
+#define RESYNC_GUARD 50       // ms
+#define RESYNC_GIVE_UP 1500   // ms
 
 /*
  * Intialize NeoPixels
@@ -71,11 +111,11 @@ ClickButton downButton(BTN_DOWN, LOW, CLICKBTN_PULLUP);
 // On a Trinket or Gemma we suggest changing this to 1:
 #define LED_PIN 6
 
-// How many NeoPixels are attached to the Arduino?
-#define LED_COUNT 27
+// How many NeoPixels are attached to the Arduino? (see the layout in frame.h)
+#define LED_COUNT LAYOUT_PIXELS
 
 // Declare our NeoPixel strip object:
-Adafruit_NeoPixel strip(LED_COUNT, LED_PIN, NEO_RGB + NEO_KHZ800);
+Adafruit_NeoPixel strip(LED_COUNT, LED_PIN, LAYOUT_COLOR_ORDER + NEO_KHZ800);
 // Argument 1 = Number of pixels in NeoPixel strip
 // Argument 2 = Arduino pin number (most are valid)
 // Argument 3 = Pixel type flags, add together as needed:
@@ -92,29 +132,12 @@ Adafruit_NeoPixel strip(LED_COUNT, LED_PIN, NEO_RGB + NEO_KHZ800);
  */
 
 /*
- * Define which pixels are for each digit
+ * Digit groups, their sizes and what they show are defined by the layout in layout.h
  */
 
-// The LEDs are laid out to be compatible with using sections of LED strip:
-//
-// HourTens             HourOnes              MinuteTens             MinuteOnes
-//     0      ---     1 --  2 --  3    ---      4 --  5    ---     6 --   7 -- 8
-//                                                                             |
-//     17     ---    16 -- 15 -- 14    ---     13 -- 12    ---    11 --  10 -- 9
-//     |
-//     18     ---    19 -- 20 -- 21    ---     22 -- 23    ---    24 --  25 -- 26
-
-const static byte PROGMEM hourTensLEDs[3]   = { 0, 17, 18 };
-const static byte PROGMEM hourTensMax       = 3;
-const static byte PROGMEM hourOnesLEDs[9]   = { 1, 2, 3, 16, 15, 14, 19, 20, 21 };
-const static byte PROGMEM hourOnesMax       = 9;
-const static byte PROGMEM minuteTensLEDs[6] = { 4, 5, 13, 12, 22, 23 };
-const static byte PROGMEM minuteTensMax     = 6;
-const static byte PROGMEM minuteOnesLEDs[9] = { 6, 7, 8, 11, 10, 9, 24, 25, 26 };
-const static byte PROGMEM minuteOnesMax     = 9;
-
-const static byte PROGMEM logo_V_size         = 5;
-const static byte PROGMEM logo_V[logo_V_size] = { 1, 3, 16, 14, 20 };
+// "V" drawn in the hour ones digit for the version display: its corners and bottom middle
+static_assert(groupCols(HOUR_ONES) == 3, "the version logo is drawn on 3 columns");
+const FrameBits logoV = groupBits(HOUR_ONES, 0b010101101);
 
 /*
  * Min, max brightness and interval between
@@ -126,54 +149,63 @@ byte brightnessStep = 50;
 
 /*
  * Internal time tracking (between updates from RTC)
+ *
+ * Packed BCD, as read from the RTC (see bcd.h), with hour in 24h
  */
 
-byte hour   = 0;
-byte minute = 0;
-byte second = 0;
+byte hour   = 0x00;
+byte minute = 0x00;
+byte second = 0x00;
 
 /*
  * Tracking of event timing in internal loops
  */
 
-unsigned long lastRTCUpdate     = 0;        // Last time we got an update from the RTC
-unsigned long RTCInterval       = 120000;   // How often up to update from RTC (ms)
+unsigned long lastRTCUpdate     = 0;        // RTC second edge of the last resync
+unsigned long lastTick          = 0;        // Last time we moved forward 1 second
+unsigned int  tickLength        = 1000;     // ms of millis() until the next one
+bool          resyncing         = true;     // Reading the RTC until its seconds change
+bool          resyncAnchored    = false;    // Can the next resync measure the drift from the last
+byte          resyncSecond      = 0xFF;     // Seconds of the last read in this resync
+unsigned long resyncFrom        = 0;        // When to start reading
+unsigned long resyncPollAt      = 0;        // When the last read was requested
+unsigned long resyncPrevPollAt  = 0;        // and the one before
 unsigned long blinkInterval     = 333;      // Blink timing in menus
 unsigned long lastBlink         = 0;        // Last time menu blink changed on/off
 bool          blinkState        = true;     // Is menu blink on or off
 unsigned long lastDisplayUpdate = 0;        // Last time we updated the pixel display
+byte          shownHour         = 0xFF;     // Time on the display (BCD, 24h)
+byte          shownMinute       = 0xFF;
+byte          shownSecond       = 0xFF;
+byte          lastSecond        = 0xFF;     // Second of the last clockTick()
+byte          randomizeIn       = 0;        // Seconds to the next re-randomize (0: line up first)
+bool          redrawSeconds     = false;    // Is the redraw only for the seconds (layout.h)
+unsigned long splashStart       = 0;        // When the version splash went up
+bool          timeKnown         = false;    // Has the time been read from the RTC yet
+unsigned long timeShownAt       = 0;        // millis() when the first clock frame went out
+byte          shownBrightness   = 0;        // Brightness the palette is built for
+unsigned long lastRamp          = 0;        // Last step toward the ambient brightness
 
 /*
- * Define menu positions
+ * Define menu positions (states of the menu table, see menu.h)
  */
 
-// 0 = Display Time
-// 1 = Set Hours
-// 2 = Set Minutes Tens
-// 3 = Set Minutes Ones
-// 4 = Save settings and resume clock
-// 5 = Set update interval
-// 6 = Save update interval
-// 7 = Set color scheme
-// 8 = Save color scheme
-byte          menuPosition   = 0;
-byte          menuSaveTime   = 4;   // Menu position where time gets saved to RTC
-byte          menuSaveColor  = 8;
-byte          menuMax        = 8;       // Max menu position
-unsigned long lastMenuAction = 0;       // Time of last button press in menu
-unsigned long menuTimeout    = 20000;   // Menu timeout (no input)
-
-/*
- * Predefined colors
- */
+enum MenuPosition
+{
+  MENU_CLOCK,             // 0 = Display Time
+  MENU_SET_HOURS,         // 1 = Set Hours
+  MENU_SET_MINUTE_TENS,   // 2 = Set Minutes Tens
+  MENU_SET_MINUTE_ONES,   // 3 = Set Minutes Ones
+  MENU_SAVE_TIME,         // 4 = Save time to RTC and resume clock
+  MENU_SET_INTERVAL,      // 5 = Set update interval
+  MENU_SAVE_INTERVAL,     // 6 = Save update interval
+  MENU_SET_COLOR,         // 7 = Set color scheme
+  MENU_SAVE_COLOR,        // 8 = Save color scheme
+  MENU_SPLASH,            // 9 = Version splash at power-up
+  MENU_POSITIONS
+};
 
-const uint32_t clrRed      = strip.Color(255, 0, 0);
-const uint32_t clrGreen    = strip.Color(0, 255, 0);
-const uint32_t clrBlue     = strip.Color(0, 0, 255);
-const uint32_t clrPurple   = strip.Color(139, 0, 139);
-const uint32_t clrWhite    = strip.Color(255, 255, 255);
-const uint32_t clrDimWhite = strip.Color(50, 50, 50);
-const uint32_t clrYellow   = strip.Color(255, 255, 0);
+static_assert(MENU_POSITIONS == PROFILER_STATES, "the profiler keeps one histogram per state");
 
 /*
  * Update interval options
@@ -190,43 +222,91 @@ const unsigned int updateIntervalSlow   = 60000;   // 60 seconds
  * EEPROM is initialized with these values
  */
 
-unsigned long updateInterval  = updateIntervalMedium;   // how many ms between display updates
-uint32_t      hourTensColor   = clrRed;                 // Color of Hour Tens digit
-uint32_t      hourOnesColor   = clrGreen;               // Color of Hour Ones digit
-uint32_t      minuteTensColor = clrBlue;                // Color of Minutes Tens digit
-uint32_t      minuteOnesColor = clrPurple;              // Color of Minutes Ones digit
-byte          brightness      = brightnessMin;          // Brightness out of 255
-byte          colorScheme     = 0;                      // Pre-set color schemes
-
-/*
- * Vars for storing settings in EEPROM
- */
-
-struct ConfigSettings {
-  byte          flag;
-  unsigned long updateInterval;
-  uint32_t      hourTensColor;
-  uint32_t      hourOnesColor;
-  uint32_t      minuteTensColor;
-  uint32_t      minuteOnesColor;
-  byte          brightness;
-  byte          colorScheme;
-};
-ConfigSettings settings;
+unsigned long updateInterval = updateIntervalMedium;   // how many ms between display updates
+byte          updateSeconds  = updateIntervalMedium / 1000;   // the same in seconds, 1 to 60
+byte          brightness     = brightnessMin;                 // Brightness out of 255
+byte          colorScheme    = 0;                             // Pre-set color schemes (palette.h)
 
 /*
  * Function Declarations
  */
 void getRTCTime(void);                            // Fetch time from RTC into global vars
+void applyRTCTime(const BcdTime &);               // Copy a time read from the RTC to global vars
+void tickSecond(void);                            // Advance the global time vars by 1 second
 void setRTCTime(void);                            // Update time in RTC from global vars
-void printArray(byte[], byte);                    // Send an array to serial.print
-void clearPixels(const byte[], byte);             // Turn off all pixels in an array
-void clearPixels(const byte[], byte, uint32_t);   // Turn off all pixels in an array
-void displayVersion(void);                        // Display version
+void printArray(byte[], byte);                    // Send an array to the debug log
+void clearDisplay(void);                          // Turn off all pixels
+void beginFrame(Frame &, byte);                   // Start a frame with the digit colors
+void renderFrame(const Frame &);                  // Write a frame to the strip buffer
 void loadEEPROM(void);                            // Load saved values from EEPROM to RAM
-void displayDigit(byte, uint32_t, uint32_t, const byte[], byte,
-                  bool);     // Send a digit to the display
-void setColorScheme(void);   // Choose a pre-set color scheme
+void setUpdateInterval(unsigned long);            // Set updateInterval and updateSeconds
+void setColorScheme(void);   // Build the palette for the color scheme and brightness
+byte targetBrightness(void);        // The setting, or what the ambient light makes of it
+void showBrightness(byte);          // Rebuild the palette at a brightness and redraw
+void followAmbient(void);           // Step the shown brightness toward the target
+void handleSerialCommand(void);     // Act on a command character from the serial console
+void keepTime(void);                // Advance the clock and resync it from the RTC
+byte displayHour(byte);             // An hour (BCD, 24h) as the layout shows it
+void resyncPoll(void);              // Start resyncs and request their reads
+void resyncRead(const BcdTime &);   // Look for the RTC's second edge in a read
+
+// Menu state handlers
+void clockEnter(void);
+void clockTick(void);
+void clockRender(void);
+void setHoursTick(void);
+void setMinuteTensTick(void);
+void setMinuteOnesTick(void);
+void setHoursRender(void);
+void setMinuteTensRender(void);
+void setMinuteOnesRender(void);
+void setTimeEnter(void);
+void saveTimeEnter(void);
+void setIntervalEnter(void);
+void setIntervalTick(void);
+void setIntervalRender(void);
+void saveIntervalEnter(void);
+void setColorEnter(void);
+void setColorTick(void);
+void setColorRender(void);
+void saveColorEnter(void);
+void splashEnter(void);
+void splashTick(void);
+void splashRender(void);
+
+/*
+ * Menu table
+ *
+ * Set, long Set, long Up, long Down and no input for MENU_TIMEOUT lead from state to state as
+ * below; Up and Down short presses are the states' own, in their tick handlers. setup() starts
+ * in MENU_SPLASH, which moves on to the clock by itself or on any long press.
+ */
+
+#define S MENU_STAY
+
+const MenuState menuStates[MENU_POSITIONS] PROGMEM = {
+  // enter, tick, exit, render,
+  // { Set, long Set, long Up, long Down, idle }
+  { clockEnter, clockTick, NULL, clockRender,
+    { S, MENU_SET_HOURS, MENU_SET_INTERVAL, MENU_SET_COLOR, S } },
+  { setTimeEnter, setHoursTick, NULL, setHoursRender,
+    { MENU_SET_MINUTE_TENS, S, S, S, MENU_SAVE_TIME } },
+  { setTimeEnter, setMinuteTensTick, NULL, setMinuteTensRender,
+    { MENU_SET_MINUTE_ONES, S, S, S, MENU_SAVE_TIME } },
+  { setTimeEnter, setMinuteOnesTick, NULL, setMinuteOnesRender,
+    { MENU_SAVE_TIME, S, S, S, MENU_SAVE_TIME } },
+  { saveTimeEnter, NULL, NULL, NULL, { S, S, S, S, S } },
+  { setIntervalEnter, setIntervalTick, NULL, setIntervalRender,
+    { MENU_SAVE_INTERVAL, S, MENU_SAVE_INTERVAL, S, MENU_SAVE_INTERVAL } },
+  { saveIntervalEnter, NULL, NULL, NULL, { S, S, S, S, S } },
+  { setColorEnter, setColorTick, NULL, setColorRender,
+    { MENU_SAVE_COLOR, S, S, S, MENU_SAVE_COLOR } },
+  { saveColorEnter, NULL, NULL, NULL, { S, S, S, S, S } },
+  { splashEnter, splashTick, NULL, splashRender,
+    { S, MENU_CLOCK, MENU_CLOCK, MENU_CLOCK, S } },
+};
+
+#undef S
 
 void setup() {
   Serial.begin(115200);
@@ -236,620 +316,721 @@ void setup() {
    */
 
   loadEEPROM();
+  logFlush();   // setup() can afford to block; don't let the settings report fill the log
 
   /*
    * Init NeoPixel strip
    */
   strip.begin();   // INITIALIZE NeoPixel strip object (REQUIRED)
-  // Set all pixels to off
-  strip.clear();
-  strip.setBrightness(brightness);   // Set BRIGHTNESS (max = 255)
-  strip.show();                      // Commit the change
+  // Set all pixels to off; brightness is applied by the palette (loadEEPROM() built it)
+  clearDisplay();
 
   /*
-   * Init buttons
+   * Put the version splash up; it times itself out in loop(), so the rest of setup() and the
+   * first time fetch happen while it shows
    */
 
-  // Not sure if the pinMode() calls are needed with ClickButton
-  // but it can't hurt
-  pinMode(BTN_UP, INPUT_PULLUP);
-  pinMode(BTN_DOWN, INPUT_PULLUP);
-  pinMode(BTN_SET, INPUT_PULLUP);
-
-  const int DEBOUNCE    = 30;     // ms to wait for debouncing
-  const int MULTI_CLICK = 50;     // how long must pass between multiple clicks
-  const int LONG_CLICK  = 1000;   // length of a long press
+  menuBegin(menuStates, MENU_SPLASH);
 
-  setButton.debounceTime   = DEBOUNCE;
-  setButton.multiclickTime = MULTI_CLICK;
-  setButton.longClickTime  = LONG_CLICK;
-
-  upButton.debounceTime   = DEBOUNCE;
-  upButton.multiclickTime = MULTI_CLICK;
-  upButton.longClickTime  = LONG_CLICK;
+  /*
+   * Init buttons
+   */
 
-  downButton.debounceTime   = DEBOUNCE;
-  downButton.multiclickTime = MULTI_CLICK;
-  downButton.longClickTime  = LONG_CLICK;
+  // Sampled and debounced from a timer interrupt from here on
+  buttonsBegin(buttonPins);
 
   /*
    * Initialize the RTC
    */
 
-  if (!rtc.begin()) {
-    Serial.println(F("Couldn't find RTC"));
-    strip.fill(clrRed);
-    strip.show();
+  if (!ds3231Begin()) {
+    logError.println(F("Couldn't find RTC"));
+    strip.fill(strip.Color(paletteLevel(brightness), 0, 0));
+    powerLimit(strip.getPixels(), LAYOUT_PIXELS * paletteLevel(brightness));
+    frameShow(strip);
+    logFlush();
     while (1) {};
   }
 
-  if (rtc.lostPower()) {
-    Serial.println(F("RTC lost power, setting time to default"));
-    rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
+  if (ds3231LostPower()) {
+    logWarn.println(F("RTC lost power, setting time to default"));
+
+    // Build time, converted at compile time
+    const BcdTime buildTime = { bcdFromChars(__TIME__[0], __TIME__[1]),
+                                bcdFromChars(__TIME__[3], __TIME__[4]),
+                                bcdFromChars(__TIME__[6], __TIME__[7]) };
+    ds3231WriteTime(buildTime);
   }
-  // rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
 
+#ifdef RTC_SQW
+  ds3231StartTicks(RTC_SQW_PIN);
   getRTCTime();
+#else
+  // Read in the background by keepTime() from the splash's first pass
+#endif
 
   /*
-   * Initialize the RNG with input from a disconnected pin
-   *
-   * Hopefully that introduces some actual randomness
+   * Seed the pattern RNG from ADC noise on a disconnected pin and watchdog jitter (the first
+   * RTC read is mixed in when it arrives)
    */
-  randomSeed(analogRead(0));
+  rngBegin();
 
-  displayVersion();
+#ifdef AMBIENT_LIGHT
+  // The ADC belongs to the light sensor from here on, so after rngBegin()'s analogRead()s
+  ambientStart();
+#endif
 
-  Serial.println(F("End setup()"));
+  logInfo.println(F("End setup()"));
 }
 
 void loop() {
-  // var to hold the last time we moved forward 1 second
-  // static vars init once and keep value between calls
-  static unsigned long lastTick = 0;
+  PROFILE_LOOP_BEGIN(menuPosition);
+  TELEMETRY_COUNT(loops);
+
+  handleSerialCommand();
+  logDrain();
+  ds3231Update();
+  storePoll();
 
   // Check for any button presses that have been queued
-  setButton.Update();
-  upButton.Update();
-  downButton.Update();
-
-  if (menuPosition == 0) {
-    // Update time from RTC
-    if ((unsigned long)(millis() - lastRTCUpdate) > RTCInterval) {
-      lastRTCUpdate = millis();
-      lastTick      = lastRTCUpdate;
-      getRTCTime();
-    }
+  buttonsPoll();
+  TELEMETRY_BUTTONS(buttonClicks[BUTTON_SET], buttonClicks[BUTTON_UP],
+                    buttonClicks[BUTTON_DOWN]);
+
+  // Presses that move between menu states; short Up and Down are left to the states
+  byte events = 0;
+  if (buttonClicks[BUTTON_SET] > 0) { events |= MENU_EVENT(EVENT_SET); }
+  if (buttonClicks[BUTTON_SET] < 0) { events |= MENU_EVENT(EVENT_SET_LONG); }
+  if (buttonClicks[BUTTON_UP] < 0) { events |= MENU_EVENT(EVENT_UP_LONG); }
+  if (buttonClicks[BUTTON_DOWN] < 0) { events |= MENU_EVENT(EVENT_DOWN_LONG); }
+  menuRun(menuStates, events);
+#ifdef AMBIENT_LIGHT
+  followAmbient();
+#endif
+
+  TELEMETRY_POLL(hour, minute, second);
+#ifdef CROSSFADE
+  // Last, so the step can see every deadline this pass reported
+  fadeTick(strip);
+#endif
+
+  LATENCY_PASS_END();
+  PROFILE_LOOP_END();
+  schedSleep();
+}
 
-    // Update our stored time vars once every second
-    if ((unsigned long)(millis() - lastTick) >= 1000) {
-      Serial.println(F("Updating seconds"));
-      Serial.print(F("lastDisplayUpdate = "));
-      Serial.print(lastDisplayUpdate);
-      Serial.print(F(", millis() = "));
-      Serial.print(millis());
-      Serial.println();
-
-      lastTick = millis();
-      second++;
-
-      if (second > 59) {
-        second = 0;
-        minute++;
-      }
-      if (minute > 59) {
-        minute = 0;
-        hour++;
-      }
-
-      // hour is kept as 24h internally, changed to 12h for display
-      if (hour > 23) { hour = 0; }
-    }
+/*
+ * Advance the clock, which only runs while it's displayed
+ */
+
+void keepTime(void) {
+#ifdef RTC_SQW
+  // Seconds are counted from the RTC's 1 Hz output, so there's nothing to poll or resync
+  // (the tick interrupt wakes loop() itself)
+  for (byte ticks = ds3231TakeTicks(); ticks > 0; ticks--) { tickSecond(); }
+#else
+  // Reads from the RTC run in the background and are looked at when they arrive
+  BcdTime now;
+  if (ds3231TimeReady(now)) { resyncRead(now); }
+
+  // Update our stored time vars once every (drift-corrected) second, catching up on any missed
+  while (timeKnown && (unsigned long)(millis() - lastTick) >= tickLength) {
+    logDebug.println(F("Updating seconds"));
+    logDebug.print(F("lastDisplayUpdate = "));
+    logDebug.print(lastDisplayUpdate);
+    logDebug.print(F(", millis() = "));
+    logDebug.print(millis());
+    logDebug.println();
+
+    lastTick += tickLength;
+    tickLength = driftTick();
+    tickSecond();
   }
+  schedAt(lastTick + tickLength);
 
-  /* If we're in menuPosition == 0 (meaning we're in normal diplay mode)
-   * and the updateInterval has passed (meaning we should update the display)
-   *
-   * In other words this is what should run when we're not in a menu
-   */
-  if ((menuPosition == 0) && ((((unsigned long)(millis() - lastDisplayUpdate)) > updateInterval) ||
-                              lastDisplayUpdate == 0)) {
-    lastDisplayUpdate = millis();
-    if (Serial) {
-      Serial.print(F("Updating display: "));
-      Serial.print(hour);
-      Serial.print(F(":"));
-      Serial.println(minute);
-    }
+  resyncPoll();
+#endif
+}
 
-    // Hour is always tracked as 24h, updated to 12h for display
-    byte displayHour = hour;
-    if (displayHour > 12) { displayHour -= 12; }
-    if (displayHour == 0) { displayHour = 12; }
+/*
+ * RTC resync (without RTC_SQW)
+ */
 
-    displayDigit((int)(displayHour / 10), hourTensColor, 0, hourTensLEDs, hourTensMax, true);
-    displayDigit(((int)(displayHour - ((int)(displayHour / 10) * 10))), hourOnesColor, 0,
-                 hourOnesLEDs, hourOnesMax, true);
-    displayDigit((int)(minute / 10), minuteTensColor, 0, minuteTensLEDs, minuteTensMax, true);
-    displayDigit(((int)(minute - ((int)(minute / 10) * 10))), minuteOnesColor, 0, minuteOnesLEDs,
-                 minuteOnesMax, true);
+// Seconds since midnight of a BCD time
+long secondsOfDay(byte h, byte m, byte s) {
+  return bcdToBin(h) * 3600L + bcdToBin(m) * 60L + bcdToBin(s);
+}
 
-    // Only run strip.show when needed, otherwise it wastes cycles
-    strip.show();
+void resyncPoll(void) {
+  if (!resyncing) {
+    if ((unsigned long)(millis() - lastRTCUpdate) < driftInterval) {
+      schedAt(lastRTCUpdate + driftInterval);
+      return;
+    }
+    resyncing    = true;
+    resyncSecond = 0xFF;
+    resyncFrom   = lastTick + tickLength - RESYNC_GUARD;
   }
 
-  /*
-   * Menu handling
-   *
-   * Loop above doesn't run when we're in a menu - these run instead
-   */
-
-  // Menu position 1 == set hours (tens and ones)
-  if (menuPosition == 1) {
-    // Save time and exit if no button presses in menuTimeout ms
-    if (millis() - lastMenuAction > menuTimeout) { menuPosition = menuSaveTime; }
-
-    if (upButton.clicks > 0) {
-      lastMenuAction = millis();
+  if (timeKnown && (long)(millis() - resyncFrom) < 0) {
+    schedAt(resyncFrom);
+    return;
+  }
 
-      hour++;
-      if (hour > 23) { hour = 0; }
-      second = 0;   // Keeps time from updating on us while we're trying to set it
+  if ((unsigned long)(millis() - resyncPollAt) >= RESYNC_POLL && ds3231RequestTime()) {
+    resyncPrevPollAt = resyncPollAt;
+    resyncPollAt     = millis();
+  }
+  schedAt(resyncPollAt + RESYNC_POLL);
+}
 
-      // Reset blink state on button press
-      blinkState = false;
-      lastBlink  = 0;
-    }
-    if (downButton.clicks > 0) {
-      lastMenuAction = millis();
-
-      if (hour == 0) {
-        hour = 23;
-      } else {
-        hour--;
-      }
-      second = 0;   // Keeps time from updating on us while we're trying to set it
-
-      // Reset blink state on button press
-      blinkState = false;
-      lastBlink  = 0;
+void resyncRead(const BcdTime &now) {
+  // The first read after power-up sets the time to show until the edge is found
+  if (!timeKnown) {
+    applyRTCTime(now);
+    lastTick   = millis();
+    resyncFrom = lastTick;
+  }
+  if (!resyncing) { return; }
+
+  if (resyncSecond == 0xFF || now.second == resyncSecond) {
+    resyncSecond = now.second;
+    if ((unsigned long)(millis() - resyncFrom) > RESYNC_GIVE_UP) {
+      logWarn.println(F("No RTC second edge, taking its time as it is"));
+      applyRTCTime(now);
+      lastTick       = millis();
+      lastRTCUpdate  = lastTick;
+      resyncing      = false;
+      resyncAnchored = false;
     }
+    return;
+  }
 
-    // Every blinkInterval ms, update the display
-    if ((millis() - lastBlink) > blinkInterval) {
-      lastBlink  = millis();
-      blinkState = !blinkState;
-
-      strip.fill(clrDimWhite);
-
-      // Minutes digits don't blink
-      displayDigit((int)(minute / 10), minuteTensColor, clrDimWhite, minuteTensLEDs, minuteTensMax,
-                   false);
-      displayDigit(((int)(minute - ((int)(minute / 10) * 10))), minuteOnesColor, clrDimWhite,
-                   minuteOnesLEDs, minuteOnesMax, false);
-
-      if (blinkState) {
-        byte displayHour = hour;
-        if (displayHour > 12) { displayHour -= 12; }
-        if (displayHour == 0) { displayHour = 12; }
-
-        displayDigit((int)(displayHour / 10), hourTensColor, clrDimWhite, hourTensLEDs, hourTensMax,
-                     false);
-        displayDigit(((int)(displayHour - ((int)(displayHour / 10) * 10))), hourOnesColor,
-                     clrDimWhite, hourOnesLEDs, hourOnesMax, false);
-      } else {
-        clearPixels(hourOnesLEDs, hourOnesMax);
-        clearPixels(hourTensLEDs, hourTensMax);
-      }
-
-      strip.show();
-    }
+  // The seconds advanced between the last two reads: how far was the counted time off then?
+  unsigned long edge    = resyncPrevPollAt + (resyncPollAt - resyncPrevPollAt) / 2;
+  long          counted = secondsOfDay(hour, minute, second) * 1000L + (long)(edge - lastTick);
+  long          offset  = counted - secondsOfDay(now.hour, now.minute, now.second) * 1000L;
+  if (offset > 43200000L) { offset -= 86400000L; }
+  if (offset < -43200000L) { offset += 86400000L; }
+
+  if (resyncAnchored) {
+    driftMeasured(offset, edge - lastRTCUpdate);
+    logInfo.print(F("Resync off by "));
+    logInfo.print(offset);
+    logInfo.print(F(" ms, drift "));
+    logInfo.print(driftPpm);
+    logInfo.println(F(" ppm"));
   }
 
-  // Set minute - tens digit
-  if (menuPosition == 2) {
-    // Save time and exit if no button presses in menuTimeout ms
-    if (millis() - lastMenuAction > menuTimeout) { menuPosition = menuSaveTime; }
+  applyRTCTime(now);
+  lastTick       = edge;
+  lastRTCUpdate  = edge;
+  resyncing      = false;
+  resyncAnchored = true;
+}
 
-    if (upButton.clicks > 0) {
-      lastMenuAction = millis();
+/*
+ * Menu position 0 - display the time
+ */
 
-      minute += 10;
-      if (minute > 59) { minute -= 60; }
-      second = 0;   // Keeps time from updating on us while we're trying to set it
+void clockEnter(void) {
+  // Start from a blank display so the first random digits may light any pixel
+  clearDisplay();
+  menuRedraw();
+  randomizeIn = 0;
+}
 
-      blinkState = false;
-      lastBlink  = 0;
-      Serial.print(F("minute = "));
-      Serial.println(minute);
-    }
-    if (downButton.clicks > 0) {
-      lastMenuAction = millis();
-
-      if (minute < 10) {
-        minute += 50;
-      } else {
-        minute -= 10;
-      }
-      second = 0;   // Keeps time from updating on us while we're trying to set it
-
-      blinkState = false;
-      lastBlink  = 0;
-      Serial.print(F("minute = "));
-      Serial.println(minute);
+void clockTick(void) {
+  keepTime();
+
+  // Always redraw as soon as the time shown is out of date, on the tick that changed it. Only
+  // the extra redraws that re-randomize the pattern follow updateInterval: on the seconds it
+  // divides, so they line up with the ticks and the minute (no deadline of their own needed).
+  // A countdown of the ticks finds those seconds; it restarts on the minute, and is lined up
+  // with one division after the clock is entered, the interval changes or the seconds jump (a
+  // pass that caught up on several ticks, or a resync).
+  bool randomize = false;
+  if (second != lastSecond) {
+    if (second != bcdIncrement(lastSecond, 0x59)) { randomizeIn = 0; }
+
+    if (second == 0x00) {
+      randomizeIn = updateSeconds;
+      randomize   = true;
+    } else if (randomizeIn == 0) {
+      byte past   = bcdToBin(second) % updateSeconds;
+      randomizeIn = updateSeconds - past;
+      randomize   = past == 0;
+    } else if (--randomizeIn == 0) {
+      randomizeIn = updateSeconds;
+      randomize   = true;
     }
+  }
 
-    if ((millis() - lastBlink) > blinkInterval) {
-      lastBlink  = millis();
-      blinkState = !blinkState;
-
-      strip.fill(clrDimWhite);
-
-      // Hours digits and minute ones don't blink
-      byte displayHour = hour;
-      if (displayHour > 12) { displayHour -= 12; }
-
-      displayDigit((int)(displayHour / 10), hourTensColor, clrDimWhite, hourTensLEDs, hourTensMax,
-                   false);
-      displayDigit(((int)(displayHour - ((int)(displayHour / 10) * 10))), hourOnesColor,
-                   clrDimWhite, hourOnesLEDs, hourOnesMax, false);
-      displayDigit(((int)(minute - ((int)(minute / 10) * 10))), minuteOnesColor, clrDimWhite,
-                   minuteOnesLEDs, minuteOnesMax, false);
-
-      if (blinkState) {
-        if ((int)(minute / 10) == 0) {
-          displayDigit(minuteTensMax, clrDimWhite, clrDimWhite, minuteTensLEDs, minuteTensMax,
-                       false);
-        } else {
-          displayDigit((int)(minute / 10), minuteTensColor, clrDimWhite, minuteTensLEDs,
-                       minuteTensMax, false);
-        }
-      } else {
-        clearPixels(minuteTensLEDs, minuteTensMax);
-      }
-
-      strip.show();
-    }
+  if (hour != shownHour || minute != shownMinute || randomize) {
+    menuRedraw();
+  } else if (second != lastSecond && layoutShowsSeconds()) {
+    // Only the seconds changed: the other groups keep their patterns
+    redrawSeconds = true;
+    menuRedraw();
   }
+  lastSecond = second;
 
-  // Set minute - ones digit
-  if (menuPosition == 3) {
-    // Save time and exit if no button presses in menuTimeout ms
-    if (millis() - lastMenuAction > menuTimeout) { menuPosition = menuSaveTime; }
+  // Up button - short click cycles through brightness settings
+  if (buttonClicks[BUTTON_UP] > 0) {
+    brightness += brightnessStep;
+    if ((brightness > brightnessMax) || (brightness < brightnessMin)) { brightness = brightnessMin; }
 
-    if (upButton.clicks > 0) {
-      lastMenuAction = millis();
+    showBrightness(targetBrightness());   // Update brightness immediately
 
-      minute += 1;
-      if (minute % 10 == 0) { minute -= 10; }
-      second = 0;
+    settings.brightness = brightness;
+    settingsChanged();
 
-      blinkState = false;
-      lastBlink  = 0;
-    }
-    if (downButton.clicks > 0) {
-      lastMenuAction = millis();
-
-      if (minute == 0) {
-        minute += 9;
-      } else {
-        minute -= 1;
-        if (minute % 10 == 9) { minute += 10; }
-      }
-      second = 0;
-
-      blinkState = false;
-      lastBlink  = 0;
-    }
+    logInfo.print(F("Brightness set to "));
+    logInfo.println(brightness);
+  }
+}
 
-    if ((millis() - lastBlink) > blinkInterval) {
-      lastBlink  = millis();
-      blinkState = !blinkState;
-
-      strip.fill(clrDimWhite);
-
-      // Hours digits and minute tens don't blink
-      byte displayHour = hour;
-      if (displayHour > 12) { displayHour -= 12; }
-
-      displayDigit((int)(displayHour / 10), hourTensColor, clrDimWhite, hourTensLEDs, hourTensMax,
-                   false);
-      displayDigit(((int)(displayHour - ((int)(displayHour / 10) * 10))), hourOnesColor,
-                   clrDimWhite, hourOnesLEDs, hourOnesMax, false);
-      displayDigit((int)(minute / 10), minuteTensColor, clrDimWhite, minuteTensLEDs, minuteTensMax,
-                   false);
-
-      if (blinkState) {
-        // Instead of being blank for 0, blink all white
-        if ((int)(minute % 10) == 0) {
-          displayDigit(minuteOnesMax, clrDimWhite, clrDimWhite, minuteOnesLEDs, minuteOnesMax,
-                       false);
-        } else {
-          displayDigit((int)(minute % 10), minuteOnesColor, clrDimWhite, minuteOnesLEDs,
-                       minuteOnesMax, false);
-        }
-      } else {
-        clearPixels(minuteOnesLEDs, minuteOnesMax);
-      }
-
-      strip.show();
-    }
+// Hour is always tracked as 24h, shown as 12h unless the layout has 24 (layout.h)
+byte displayHour(byte bcd) { return LAYOUT_HOURS == 24 ? bcd : bcdHour12(bcd); }
+
+void clockRender(void) {
+  const byte shown[3] = { displayHour(shownHour), shownMinute, shownSecond };
+  const byte time[3]  = { displayHour(hour), minute, second };
+
+  lastDisplayUpdate = millis();
+  shownHour         = hour;
+  shownMinute       = minute;
+  shownSecond       = second;
+  if (Serial) {
+    logDebug.print(F("Updating display: "));
+    logDebug.print(hour, HEX);
+    logDebug.print(F(":"));
+    logDebug.println(minute, HEX);
   }
 
-  // This menu position isn't interactive - just signals we're done setting time
-  if (menuPosition == menuSaveTime) {
-    // Save global time vars to RTC
-    setRTCTime();
-
-    // Reset menu to none
-    menuPosition = 0;
-
-    // Reset the display (needed b/c our randomization logic looks for blank pixels)
-    strip.clear();
-    // No strip.show needed here, the next update run will get it immediately
-
-    // Make sure we update the display immediately
-    lastDisplayUpdate = 0;
-  }
-
-  // Set display update interval
-  if (menuPosition == 5) {
-    if (millis() - lastMenuAction > menuTimeout) { menuPosition = menuSaveTime; }
-    if (upButton.clicks > 0) {
-      switch (updateInterval) {
-        default:
-        case updateIntervalFast:
-          updateInterval = updateIntervalMedium;
-          break;
-        case updateIntervalMedium:
-          updateInterval = updateIntervalSlow;
-          break;
-        case updateIntervalSlow:
-          updateInterval = updateIntervalFast;
-          break;
-      }
-      strip.show();
-      lastBlink      = 0;
-      lastMenuAction = millis();
+  Frame frame;
+  beginFrame(frame, PALETTE_OFF);
+  for (byte g = 0; g < DIGIT_GROUPS; g++) {
+    byte digit = frameTimeDigit(g, time);
+    if (layoutShowsSeconds() && redrawSeconds && digit == frameTimeDigit(g, shown)) {
+      frame.lit |= frameLit & frameGroup(g);
+    } else {
+      frame.lit |= frameRandomDigit(g, digit);
     }
+  }
+  redrawSeconds = false;
+  renderFrame(frame);
+
+  // Only pushed to the strip if the pattern actually changed
+#ifdef CROSSFADE
+  fadeShow(strip);
+#else
+  frameShow(strip);
+#endif
+
+  // Time to the first correct time on the display; millis() starts after the bootloader
+  if (timeKnown && timeShownAt == 0) {
+    timeShownAt = millis();
+    logInfo.print(F("Time shown "));
+    logInfo.print(timeShownAt);
+    logInfo.println(F(" ms after reset"));
+  }
+}
 
-    if ((millis() - lastBlink) > blinkInterval) {
-      // No actual blinking going on, but it's useful for not having to update
-      // the strip hundreds of times per second
-      lastBlink = millis();
-
-      switch (updateInterval) {
-        case updateIntervalFast:
-          displayDigit(1, clrWhite, 0, hourTensLEDs, hourTensMax, false);
-          break;
-        case updateIntervalMedium:
-          displayDigit(2, clrWhite, 0, hourTensLEDs, hourTensMax, false);
-          break;
-        case updateIntervalSlow:
-          displayDigit(3, clrWhite, 0, hourTensLEDs, hourTensMax, false);
-          break;
-        default:
-          clearPixels(hourTensLEDs, hourTensMax);
-          break;
-      }
-      strip.show();
-    }
+/*
+ * Menu positions 1-3 - set hours, minute tens, minute ones
+ *
+ * Up/down change the digit being set, which blinks; the others stay lit. Unlit pixels are dim
+ * white, so a 0 shows as a dim digit.
+ */
+
+// Show the digit being set lit and restart its blink
+void restartBlink(void) {
+  blinkState = true;
+  lastBlink  = millis();
+  menuRedraw();
+}
+
+// Blink the digit being set every blinkInterval ms
+void blinkTick(void) {
+  if ((millis() - lastBlink) > blinkInterval) {
+    lastBlink  = millis();
+    blinkState = !blinkState;
+    menuRedraw();
   }
+  schedAt(lastBlink + blinkInterval + 1);
+}
 
-  // Another non-interactive menu position, this one saves the
-  // display interval to EEPROM and then exits the menu
-  if (menuPosition == 6) {
-    Serial.print(F("Setting updateInterval = "));
-    Serial.println(updateInterval);
+void timeEdited(void) {
+  menuTouch();
+  second = 0;   // Keeps time from updating on us while we're trying to set it
+  restartBlink();
 
-    settings.updateInterval = updateInterval;
-    EEPROM.put(0, settings);
+  logDebug.print(F("time = "));
+  logDebug.print(hour, HEX);
+  logDebug.print(F(":"));
+  logDebug.println(minute, HEX);
+}
 
-    menuPosition      = 0;
-    lastDisplayUpdate = 0;
+void setTimeEnter(void) { restartBlink(); }
 
-    strip.clear();
-    strip.show();
+void setHoursTick(void) {
+  if (buttonClicks[BUTTON_UP] > 0) {
+    hour = bcdIncrement(hour, 0x23);
+    timeEdited();
+  }
+  if (buttonClicks[BUTTON_DOWN] > 0) {
+    hour = bcdDecrement(hour, 0x23);
+    timeEdited();
   }
+  blinkTick();
+}
 
-  // Color scheme chooser
-  if (menuPosition == 7) {
-    if (millis() - lastMenuAction > menuTimeout) { menuPosition = menuSaveColor; }
+void setMinuteTensTick(void) {
+  if (buttonClicks[BUTTON_UP] > 0) {
+    minute += 0x10;
+    if (minute > 0x59) { minute -= 0x60; }
+    timeEdited();
+  }
+  if (buttonClicks[BUTTON_DOWN] > 0) {
+    if (minute < 0x10) {
+      minute += 0x50;
+    } else {
+      minute -= 0x10;
+    }
+    timeEdited();
+  }
+  blinkTick();
+}
 
-    if (downButton.clicks > 0) {
-      colorScheme++;
-      setColorScheme();
+void setMinuteOnesTick(void) {
+  if (buttonClicks[BUTTON_UP] > 0) {
+    minute = bcdOnesUp(minute);
+    timeEdited();
+  }
+  if (buttonClicks[BUTTON_DOWN] > 0) {
+    minute = bcdOnesDown(minute);
+    timeEdited();
+  }
+  blinkTick();
+}
 
-      lastBlink      = 0;
-      lastMenuAction = millis();
+// Draw the time with the digit groups in 'blinking' (a bit per DigitGroup) off in the off phase
+void renderSetTime(byte blinking) {
+  const byte time[3] = { displayHour(hour), minute, second };
+
+  Frame frame;
+  beginFrame(frame, PALETTE_DIM_WHITE);
+  for (byte g = 0; g < DIGIT_GROUPS; g++) {
+    if (!blinkState && (blinking & (1 << g))) {
+      frame.unlit[g] = PALETTE_OFF;
+    } else {
+      frame.lit |= frameDigit(g, frameTimeDigit(g, time));
     }
+  }
 
-    if ((millis() - lastBlink) > blinkInterval) {
-      lastBlink  = millis();
-      blinkState = true; // don't blink the color chooser
+  renderFrame(frame);
+  frameShow(strip);
+}
 
-      if (blinkState) {
-        displayDigit(hourTensMax, hourTensColor, 0, hourTensLEDs, hourTensMax, false);
-        displayDigit(hourOnesMax, hourOnesColor, 0, hourOnesLEDs, hourOnesMax, false);
-        displayDigit(minuteTensMax, minuteTensColor, 0, minuteTensLEDs, minuteTensMax, false);
-        displayDigit(minuteOnesMax, minuteOnesColor, 0, minuteOnesLEDs, minuteOnesMax, false);
-      } else {
-        strip.clear();
-      }
+void setHoursRender(void) { renderSetTime((1 << HOUR_TENS) | (1 << HOUR_ONES)); }
 
-      strip.show();
-    }
-  }
+void setMinuteTensRender(void) { renderSetTime(1 << MINUTE_TENS); }
 
-  // Save color scheme - non-interactive
-  if (menuPosition == menuSaveColor) {
-    Serial.print(F("Setting colorScheme = "));
-    Serial.println(colorScheme);
+void setMinuteOnesRender(void) { renderSetTime(1 << MINUTE_ONES); }
 
-    settings.colorScheme = colorScheme;
-    EEPROM.put(0, settings);
+/*
+ * Menu position 4 - not interactive, saves the time to the RTC and resumes the clock
+ */
 
-    menuPosition      = 0;
-    lastDisplayUpdate = 0;
+void saveTimeEnter(void) {
+  setRTCTime();
+  menuGo(MENU_CLOCK);
+}
 
-    strip.clear();
-    strip.show();
-  }
+/*
+ * Menu position 5 - choose the display update interval
+ *
+ * Up cycles through the rates, shown on the left-most column.
+ */
 
-  /*
-   * Handle any button presses
-   */
+void setIntervalEnter(void) {
+  clearDisplay();
+  menuRedraw();
+}
 
-  // Set button - short click
-  if (setButton.clicks > 0) {
-    // If we're in a menu, cycle to the next menu
-    if (menuPosition > 0) {
-      menuPosition++;
-      if (menuPosition > menuMax) { menuPosition = 0; }
-      lastMenuAction = millis();
-      Serial.print(F("Entering menu: "));
-      Serial.println(menuPosition);
+void setIntervalTick(void) {
+  if (buttonClicks[BUTTON_UP] > 0) {
+    switch (updateInterval) {
+      default:
+      case updateIntervalFast:
+        setUpdateInterval(updateIntervalMedium);
+        break;
+      case updateIntervalMedium:
+        setUpdateInterval(updateIntervalSlow);
+        break;
+      case updateIntervalSlow:
+        setUpdateInterval(updateIntervalFast);
+        break;
     }
+    menuTouch();
+    menuRedraw();
   }
+}
 
-  // Set button - long click
-  if (setButton.clicks < 0) {
-    // long press is only used for entering menu
-    if (menuPosition == 0) {
-      menuPosition++;
-      lastMenuAction = millis();
-      Serial.println(F("Entering Menu Mode"));
-    }
+void setIntervalRender(void) {
+  Frame frame;
+  beginFrame(frame, PALETTE_OFF);
+  frame.color[HOUR_TENS] = PALETTE_WHITE;
+
+  switch (updateInterval) {
+    case updateIntervalFast:
+      frame.lit = frameDigit(HOUR_TENS, 1);
+      break;
+    case updateIntervalMedium:
+      frame.lit = frameDigit(HOUR_TENS, 2);
+      break;
+    case updateIntervalSlow:
+      frame.lit = frameDigit(HOUR_TENS, 3);
+      break;
+    default:
+      break;
   }
+  renderFrame(frame);
+  frameShow(strip);
+}
 
-  // Up button - short click
-  if (upButton.clicks > 0) {
-    // Outside of menus, this cycles through brightness settings
-    // (Inside menus it's handled by that code)
-    if (menuPosition == 0) {
-      brightness += brightnessStep;
-      if ((brightness > brightnessMax) || (brightness < brightnessMin)) { brightness = brightnessMin; }
+/*
+ * Menu position 6 - not interactive, saves the display interval to EEPROM and resumes the
+ * clock
+ */
 
-      strip.setBrightness(brightness);
-      strip.show();   // Update brightness immediately
+void saveIntervalEnter(void) {
+  logInfo.print(F("Setting updateInterval = "));
+  logInfo.println(updateInterval);
 
-      settings.brightness = brightness;
-      EEPROM.put(0, settings);
+  settings.updateInterval = updateInterval;
+  settingsChanged();
+  menuGo(MENU_CLOCK);
+}
 
-      Serial.print(F("Brightness set to "));
-      Serial.println(brightness);
-    }
-  }
+/*
+ * Menu position 7 - choose the color scheme
+ *
+ * Down cycles through the schemes, shown with every pixel lit.
+ */
 
-  // Up button - long click
-  if (upButton.clicks < 0) {
-    // Outside of menus, a long press here enters the update interval chooser
-    if (menuPosition == 0) {
-      // enter update interval setting menu
-      clearPixels(hourTensLEDs, hourTensMax);
-      clearPixels(hourOnesLEDs, hourOnesMax);
-      clearPixels(minuteTensLEDs, minuteTensMax);
-      clearPixels(minuteOnesLEDs, minuteOnesMax);
-      lastMenuAction = millis();
-      lastBlink      = millis() - blinkInterval;
-      menuPosition   = 5;
-    }
-    // Inside the update interval chooser, a long press saves and exits
-    else if (menuPosition == 5) {
-      menuPosition++;
-    }
-  }
+void setColorEnter(void) {
+  clearDisplay();
+  menuRedraw();
+}
 
-  // Down button - long click
-  // Enter color scheme chooser
-  if (downButton.clicks < 0) {
-    if (menuPosition == 0) {
-      clearPixels(hourTensLEDs, hourTensMax);
-      clearPixels(hourOnesLEDs, hourOnesMax);
-      clearPixels(minuteTensLEDs, minuteTensMax);
-      clearPixels(minuteOnesLEDs, minuteOnesMax);
-      lastMenuAction = millis();
-      lastBlink      = millis() - blinkInterval;
-      menuPosition   = 7;
-    }
+void setColorTick(void) {
+  if (buttonClicks[BUTTON_DOWN] > 0) {
+    colorScheme++;
+    setColorScheme();
+    menuTouch();
+    menuRedraw();
   }
 }
 
+void setColorRender(void) {
+  Frame frame;
+  beginFrame(frame, PALETTE_OFF);
+  for (byte g = 0; g < DIGIT_GROUPS; g++) { frame.lit |= frameGroup(g); }
+  renderFrame(frame);
+  frameShow(strip);
+}
+
 /*
- * Update the digit display
- *
- * Takes as arguments:
- * digit - the number we're displaying from 0 to max-1 (based on number of pixels in this array)
- * color - NeoPixel RGB color value
- * pixelList - an array of the NeoPixel IDs making up this digit
- * max - the number of NeoPixels in this digit array
- * randomize - use a random order, or the pixelList array-defined order
- */
-
-void displayDigit(byte digit, uint32_t color, uint32_t bgcolor, const byte pixelList[], byte max,
-                  bool randomize) {
-  // Create an array of digits 0 to max-1.
-  byte digitOrder[max];
-  for (byte i = 0; i < max; i++) { digitOrder[i] = i; }
-
-  // Shuffle that array if we're randomizing the digits
-
-  // If digit is '0' or 'max' we can't possible ensure a change since
-  // they're all on or all off
-  if (digit < max && digit > 0) {
-    while (randomize) {
-      for (byte i = 0; i < max; i++) {
-        byte r = random(0, max);
-        byte t = digitOrder[r];
-
-        digitOrder[r] = digitOrder[i];
-        digitOrder[i] = t;
-      }
-
-      // We don't want a TRUE random, which could result in no change between updates.
-      // We want a fudged random, where (as long as we aren't displaying 0 or max) there
-      // is always a difference from the last time we displayed.
-
-      // Check each digit we're to light up
-      // If any are not lit, we have a change
-      for (byte i = 0; i < digit; i++) {
-        if (strip.getPixelColor(pgm_read_byte(&pixelList[digitOrder[i]])) == 0) {
-          randomize = false;
-        }
-      }
-    }
-  }
+ * Menu position 8 - not interactive, saves the color scheme to EEPROM and resumes the clock
+ */
 
-  // Clear this set of digits
-  clearPixels(pixelList, max, bgcolor);
+void saveColorEnter(void) {
+  logInfo.print(F("Setting colorScheme = "));
+  logInfo.println(colorScheme);
 
-  // For however many digits we're setting, walk through the
-  // (possibly) shuffled list of 0..max-1, and turn that pixel on
-  for (byte i = 0; i < digit; i++) {
-    strip.setPixelColor(pgm_read_byte(&pixelList[digitOrder[i]]), color);
-  }
+  settings.colorScheme = colorScheme;
+  settingsChanged();
+  menuGo(MENU_CLOCK);
 }
 
 /*
- * Set all pixels in arr to off (black) or an optional passed color
+ * Turn off all pixels, and forget the last frame so the next random digits may light any pixel
  */
 
-void clearPixels(const byte arr[], byte max) { clearPixels(arr, max, 0); }
+void clearDisplay(void) { frameClear(strip.getPixels()); }
 
-void clearPixels(const byte arr[], byte max, uint32_t color) {
-  for (byte i = 0; i < max; i++) { strip.setPixelColor(pgm_read_byte(&arr[i]), color); }
+/*
+ * Start a frame with nothing lit, each digit group in its color and all unlit pixels in
+ * 'unlit' (a palette color, PALETTE_OFF for off)
+ */
+
+void beginFrame(Frame &frame, byte unlit) {
+  frame.lit = 0;
+  for (byte g = 0; g < DIGIT_GROUPS; g++) {
+    frame.color[g] = PALETTE_DIGIT + g;
+    frame.unlit[g] = unlit;
+  }
 }
 
 /*
- * Print the values in an array to the Serial output
+ * Write a frame to the strip's pixel buffer in one pass (frameShow() still needed)
+ */
+
+void renderFrame(const Frame &frame) { frameRender(frame, strip.getPixels()); }
+
+/*
+ * Print the values in an array to the debug log
  */
 
 void printArray(byte arr[], byte max) {
-  if (Serial) {
-    for (byte i = 0; i < max; i++) {
-      Serial.print(arr[i]);
-      Serial.print(F(", "));
-    }
+  for (byte i = 0; i < max; i++) {
+    logDebug.print(arr[i]);
+    logDebug.print(F(", "));
+  }
+  logDebug.println();
+}
+
+/*
+ * Serial console
+ *
+ * Single-character commands:
+ * p - dump the loop() profile (LOOP_PROFILER builds)
+ * P - reset the loop() profile (LOOP_PROFILER builds)
+ * t - dump the button-to-display latencies (LATENCY_TRACE builds)
+ * T - reset the button-to-display latencies (LATENCY_TRACE builds)
+ * s - print how many strip.show() calls frameShow() issued and skipped
+ * l - print how many log messages were dropped because the log buffer was full
+ * e - print the settings store's EEPROM writes and the time they blocked for
+ * d - print the share of the last second the CPU spent awake
+ * r - print the clock drift estimate and the RTC resync statistics (builds without RTC_SQW)
+ * a - print the ambient light level and the brightness it calls for (AMBIENT_LIGHT builds)
+ * c - print the estimated current of the frame on the LEDs and how often frames were limited
+ * f - print the crossfades' steps per second and dropped steps (CROSSFADE builds)
+ *
+ * Replies go through the log at info level.
+ */
+
+void handleSerialCommand(void) {
+  if (!Serial.available()) { return; }
+
+  switch (Serial.read()) {
+#ifdef LOOP_PROFILER
+    case 'p':
+      logFlush();   // keep queued messages ahead of the dump, which writes to Serial directly
+      profilerDump();
+      break;
+    case 'P':
+      profilerReset();
+      logInfo.println(F("Loop profile reset"));
+      break;
+#endif
+#ifdef LATENCY_TRACE
+    case 't':
+      logFlush();   // the dump writes to Serial directly too
+      latencyDump();
+      break;
+    case 'T':
+      latencyReset();
+      logInfo.println(F("Latency trace reset"));
+      break;
+#endif
+    case 's':
+      logInfo.print(F("Shows issued "));
+      logInfo.print(frameShowsIssued);
+      logInfo.print(F(", skipped "));
+      logInfo.println(frameShowsSkipped);
+      break;
+    case 'l':
+      logInfo.print(F("Log messages dropped "));
+      logInfo.println(logDropped);
+      break;
+    case 'e':
+      logInfo.print(F("EEPROM bytes written "));
+      logInfo.print(storeBytesWritten);
+      logInfo.print(F(", blocked "));
+      logInfo.print(storeBlockedUs);
+      logInfo.print(F(" us, newest slot "));
+      logInfo.println(storeSlot());
+      break;
+    case 'd':
+      logInfo.print(F("Awake "));
+      logInfo.print(schedDutyCycle / 100);
+      logInfo.print(schedDutyCycle % 100 < 10 ? F(".0") : F("."));
+      logInfo.print(schedDutyCycle % 100);
+      logInfo.println(F("% of the last second"));
+      break;
+#ifndef RTC_SQW
+    case 'r':
+      logInfo.print(F("Drift "));
+      logInfo.print(driftPpm);
+      logInfo.print(F(" ppm from "));
+      logInfo.print(driftResyncs);
+      logInfo.print(F(" resyncs, last off by "));
+      logInfo.print(driftLastOffset);
+      logInfo.print(F(" ms, worst "));
+      logInfo.print(driftWorstOffset);
+      logInfo.print(F(" ms, every "));
+      logInfo.print(driftInterval / 1000);
+      logInfo.println(F(" s"));
+      break;
+#endif
+#ifdef AMBIENT_LIGHT
+    case 'a':
+      logInfo.print(F("Ambient light "));
+      logInfo.print(ambientLevel());
+      logInfo.print(F(" from "));
+      logInfo.print(ambientReadings);
+      logInfo.print(F(" readings, brightness "));
+      logInfo.print(shownBrightness);
+      logInfo.print(F(" toward "));
+      logInfo.print(targetBrightness());
+      logInfo.print(F(" of "));
+      logInfo.println(brightness);
+      break;
+#endif
+    case 'c':
+      logInfo.print(F("Estimated "));
+      logInfo.print(powerMa);
+      logInfo.print(F(" mA of "));
+      logInfo.print(powerDemandMa);
+      logInfo.print(F(" mA unlimited, budget "));
+      logInfo.print(POWER_BUDGET_MA);
+      logInfo.print(F(" mA, frames limited "));
+      logInfo.println(powerLimited);
+      break;
+#ifdef CROSSFADE
+    case 'f':
+      logInfo.print(F("Fades "));
+      logInfo.print(fadesStarted);
+      logInfo.print(F(", "));
+      logInfo.print(fadeFps());
+      logInfo.print(F(" steps/s, shown "));
+      logInfo.print(fadeStepsShown);
+      logInfo.print(F(", dropped "));
+      logInfo.print(fadeStepsDropped);
+      logInfo.print(F(", held "));
+      logInfo.print(fadeStepsHeld);
+      logInfo.print(F(", slowest "));
+      logInfo.print(fadeStepUs);
+      logInfo.println(F(" us"));
+      break;
+#endif
+    default:
+      break;
+  }
+}
+
+/*
+ * Advance the global time vars by one second
+ */
+void tickSecond() {
+  // hour is kept as 24h internally, changed to 12h for display
+  second = bcdIncrement(second, 0x59);
+  if (second == 0) {
+    minute = bcdIncrement(minute, 0x59);
+    if (minute == 0) { hour = bcdIncrement(hour, 0x23); }
   }
 }
 
@@ -857,22 +1038,39 @@ void printArray(byte arr[], byte max) {
  * Fetch time from RTC into global vars
  */
 void getRTCTime() {
-  DateTime now = rtc.now();
+  BcdTime now;
+#ifdef RTC_SQW
+  // A tick during the read may or may not be in the registers we got; read again until none
+  // comes in, so every tick counted from here on is one the time doesn't include yet
+  do {
+    ds3231ReadTime(now);
+  } while (ds3231TakeTicks() != 0);
+#else
+  ds3231ReadTime(now);
+#endif
+  applyRTCTime(now);
+}
 
-  hour = now.hour();
-  // if (hour > 12) { hour -= 12; }
-  minute = now.minute();
-  second = now.second();
+/*
+ * Copy a time read from the RTC into global vars
+ */
+void applyRTCTime(const BcdTime &now) {
+  TELEMETRY_RESYNC(hour, minute, second, now.hour, now.minute, now.second);
+  if (!timeKnown) { rngMix(((uint32_t)now.hour << 16 | now.minute << 8 | now.second) ^ micros()); }
+  hour      = now.hour;
+  minute    = now.minute;
+  second    = now.second;
+  timeKnown = true;
 
   if (Serial) {
-    Serial.print(F("Updating from RTC at "));
-    Serial.println(millis());
-
-    Serial.print(hour);
-    Serial.print(F(":"));
-    Serial.print(minute);
-    Serial.print(F(":"));
-    Serial.println(second);
+    logDebug.print(F("Updating from RTC at "));
+    logDebug.println(millis());
+
+    logDebug.print(hour, HEX);
+    logDebug.print(F(":"));
+    logDebug.print(minute, HEX);
+    logDebug.print(F(":"));
+    logDebug.println(second, HEX);
   }
 }
 
@@ -881,133 +1079,149 @@ void getRTCTime() {
  */
 
 void setRTCTime() {
-  // This clock isn't date-aware so it doesn't matter what date we set here
-  rtc.adjust(DateTime(2014, 1, 1, hour, minute, 0));
+  // This clock isn't date-aware, so only the time registers are set
+  const BcdTime time = { hour, minute, 0x00 };
+  ds3231QueueTime(time);
+
+#ifndef RTC_SQW
+  // Writing the seconds restarts the RTC's second, so count from here and resync soon, without
+  // measuring the drift across the jump
+  lastTick       = millis();
+  resyncing      = false;
+  resyncAnchored = false;
+  lastRTCUpdate  = millis() - driftInterval;
+#endif
 
   if (Serial) {
-    Serial.print(F("Setting RTC to "));
+    logInfo.print(F("Setting RTC to "));
 
-    Serial.print(hour);
-    Serial.print(F(":"));
-    Serial.print(minute);
-    Serial.println(F(":00"));
+    logInfo.print(hour, HEX);
+    logInfo.print(F(":"));
+    logInfo.print(minute, HEX);
+    logInfo.println(F(":00"));
   }
 }
 
 void setColorScheme(void) {
   if (Serial) {
-    Serial.print(F("setting color scheme "));
-    Serial.println(colorScheme);
+    logDebug.print(F("setting color scheme "));
+    logDebug.println(colorScheme);
   }
 
-  switch (colorScheme) {
-    default:
-      colorScheme = 0;
-    case 0:   // My personal default
-      hourTensColor   = clrRed;
-      hourOnesColor   = clrGreen;
-      minuteTensColor = clrBlue;
-      minuteOnesColor = clrPurple;
-      break;
-    case 1:   // TIX II
-      hourTensColor   = clrBlue;
-      hourOnesColor   = clrYellow;
-      minuteTensColor = clrPurple;
-      minuteOnesColor = clrGreen;
-      break;
-    case 2:                                          // Green/yellow
-      hourTensColor   = strip.Color(13, 175, 186);   // blue-green
-      hourOnesColor   = clrGreen;
-      minuteTensColor = strip.Color(154, 154, 50);
-      minuteOnesColor = clrYellow;
-      break;
-    case 3:   // Red/orange
-      hourTensColor   = clrRed;
-      hourOnesColor   = strip.Color(255, 69, 0);
-      minuteTensColor = strip.Color(255, 140, 0);
-      minuteOnesColor = clrYellow;   // strip.Color(255, 174, 66);
-      break;
-    case 4:   // Purple/blue
-      hourTensColor   = strip.Color(129, 13, 112);
-      hourOnesColor   = strip.Color(73, 29, 118); //clrPurple; // strip.Color(139, 0, 139);
-      minuteTensColor = strip.Color(23, 46, 124);
-      minuteOnesColor = strip.Color(13, 175, 186); //clrBlue;
-      break;
-    case 5:   // Christmas
-      hourTensColor   = clrRed;
-      hourOnesColor   = clrGreen;
-      minuteTensColor = clrRed;
-      minuteOnesColor = clrGreen;
-      break;
-    case 6:   // Hanukkah
-      hourTensColor   = clrWhite;
-      hourOnesColor   = clrBlue;
-      minuteTensColor = clrWhite;
-      minuteOnesColor = clrBlue;
-      break;
+  // The schemes themselves are in palette.cpp
+  if (colorScheme >= PALETTE_SCHEMES) { colorScheme = 0; }
+  shownBrightness = targetBrightness();
+  paletteBuild(colorScheme, shownBrightness);
+}
+
+/*
+ * Display brightness
+ *
+ * brightness is the setting (saved to EEPROM); shownBrightness is what the palette is built
+ * for. They're the same unless the ambient light sensor dims the display, which never touches
+ * the setting.
+ */
+
+byte targetBrightness(void) {
+#ifdef AMBIENT_LIGHT
+  return ambientBrightness(brightnessMin, brightness);
+#else
+  return brightness;
+#endif
+}
+
+void showBrightness(byte level) {
+  shownBrightness = level;
+  paletteBuild(colorScheme, level);
+  frameRefresh(strip.getPixels());
+  frameShow(strip);
+}
+
+// One level per AMBIENT_RAMP ms, so the change is smooth and costs at most one show() a step
+// (none for steps the brightness table maps to the same PWM)
+void followAmbient(void) {
+  ambientUpdate(brightnessMin, brightness);
+  byte target = targetBrightness();
+  if (target == shownBrightness) { return; }
+
+  if (millis() - lastRamp >= AMBIENT_RAMP) {
+    lastRamp = millis();
+    showBrightness(target > shownBrightness ? shownBrightness + 1 : shownBrightness - 1);
   }
+  schedAt(lastRamp + AMBIENT_RAMP);
 }
 
 void loadEEPROM(void) {
-  EEPROM.get(0, settings);
-
-  // flag is used to determine if we've saved valid data before.
-  // if we read any value other than this, assume this is our first
-  // time running on this chip, or the data is corrupt.
-  //
-  // update flag by adding 1 if changing struct, so we don't load bad data.
-  const byte flag = B10110011;
-
-  if (settings.flag != flag) {
-    Serial.print(F("EEPROM flag invalid! Expected "));
-    Serial.print(flag, BIN);
-    Serial.print(F(", got "));
-    Serial.println(settings.flag, BIN);
-    Serial.println(F("Saving default config data"));
-
-    settings.flag            = flag;
-    settings.updateInterval  = updateInterval;
-    settings.hourTensColor   = hourTensColor;
-    settings.hourOnesColor   = hourOnesColor;
-    settings.minuteTensColor = minuteTensColor;
-    settings.minuteOnesColor = minuteOnesColor;
-    settings.brightness      = brightness;
-    settings.colorScheme     = colorScheme;
-
-    EEPROM.put(0, settings);
+  if (!settingsLoad()) {
+    logWarn.println(F("No saved settings, saving default config data"));
+
+    settings.updateInterval = updateInterval;
+    settings.brightness     = brightness;
+    settings.colorScheme    = colorScheme;
+
+    settingsChanged();
+    settingsFlush();
+    setColorScheme();
   } else {
-    updateInterval = settings.updateInterval;
-    brightness     = settings.brightness;
+    setUpdateInterval(settings.updateInterval);
+    brightness = settings.brightness;
     if (brightness > brightnessMax || brightness < brightnessMin) { brightness = brightnessMin; }
-    strip.setBrightness(brightness);
 
     colorScheme = settings.colorScheme;
     setColorScheme();
 
-    Serial.println(F("Loaded settings from EEPROM:"));
-    Serial.print(F("- updateInterval = "));
-    Serial.println(updateInterval);
-    Serial.print(F("- brightness = "));
-    Serial.println(brightness);
-    Serial.print(F("- colorScheme = "));
-    Serial.print(colorScheme);
-    Serial.println();
+    logFlush();   // a migration may have logged already; keep room for the report
+    logInfo.println(F("Loaded settings from EEPROM:"));
+    logInfo.print(F("- updateInterval = "));
+    logInfo.println(updateInterval);
+    logInfo.print(F("- brightness = "));
+    logInfo.println(brightness);
+    logInfo.print(F("- colorScheme = "));
+    logInfo.print(colorScheme);
+    logInfo.println();
   }
 }
 
-void displayVersion(void) {
-  strip.clear();
+void setUpdateInterval(unsigned long interval) {
+  updateInterval = interval;
+  updateSeconds  = constrain(interval / 1000, 1, 60);
+  randomizeIn    = 0;   // line the countdown up again on the next tick
+}
 
-  for (byte i = 0; i < pgm_read_byte(&logo_V_size); i++) {
-    strip.setPixelColor(pgm_read_byte(&logo_V[i]), hourOnesColor);
-  }
-  displayDigit(VER_MAJ, minuteTensColor, 0, minuteTensLEDs, minuteTensMax, false);
-  displayDigit(VER_MIN, minuteOnesColor, 0, minuteOnesLEDs, minuteOnesMax, false);
+/*
+ * Menu position 9 - version splash at power-up
+ *
+ * Shows the version for SPLASH_SHOW, then nothing for SPLASH_GAP, then starts the clock. The
+ * time keeps running underneath, and a long press of any button goes to the clock at once.
+ */
+
+void splashEnter(void) {
+  splashStart = millis();
+  menuRedraw();
+}
 
-  strip.show();
-  delay(3000);
+void splashTick(void) {
+  keepTime();
 
-  strip.clear();
-  strip.show();
-  delay(500);
+  unsigned long shown = millis() - splashStart;
+  if (shown >= SPLASH_SHOW + SPLASH_GAP && timeKnown) {
+    menuGo(MENU_CLOCK);
+  } else if (shown >= SPLASH_SHOW) {
+    if (frameLit) { menuRedraw(); }
+    schedAt(splashStart + SPLASH_SHOW + SPLASH_GAP);
+  } else {
+    schedAt(splashStart + SPLASH_SHOW);
+  }
+}
+
+void splashRender(void) {
+  if ((unsigned long)(millis() - splashStart) >= SPLASH_SHOW) {
+    clearDisplay();
+  } else {
+    Frame frame;
+    beginFrame(frame, PALETTE_OFF);
+    frame.lit = logoV | frameDigit(MINUTE_TENS, VER_MAJ) | frameDigit(MINUTE_ONES, VER_MIN);
+    renderFrame(frame);
+  }
+  frameShow(strip);
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "menu.h"
+
+#include "log.h"
+#include "sched.h"
+
+byte menuPosition = 0;
+
+static byte          menuNext       = MENU_STAY;
+static bool          menuDirty      = false;
+static unsigned long menuLastAction = 0;
+
+void menuBegin(const MenuState *table, byte state) {
+  menuPosition = state;
+  menuTouch();
+
+  MenuState first;
+  memcpy_P(&first, &table[menuPosition], sizeof(first));
+  if (first.enter) { first.enter(); }
+
+  if (menuDirty) {
+    menuDirty = false;
+    if (first.render) { first.render(); }
+  }
+}
+
+void menuRun(const MenuState *table, byte events) {
+  MenuState state;
+  memcpy_P(&state, &table[menuPosition], sizeof(state));
+
+  if (state.tick) { state.tick(); }
+
+  if (state.on[EVENT_IDLE] != MENU_STAY) {
+    if ((unsigned long)(millis() - menuLastAction) > MENU_TIMEOUT) {
+      events |= MENU_EVENT(EVENT_IDLE);
+    } else {
+      schedAt(menuLastAction + MENU_TIMEOUT + 1);
+    }
+  }
+
+  // Unless the tick already moved on, the first event the state reacts to wins
+  for (byte e = 0; menuNext == MENU_STAY && events; e++, events >>= 1) {
+    if (events & 1) { menuNext = state.on[e]; }
+  }
+
+  while (menuNext != MENU_STAY) {
+    if (state.exit) { state.exit(); }
+
+    menuPosition = menuNext;
+    menuNext     = MENU_STAY;
+    menuDirty    = false;
+    menuTouch();
+    logInfo.print(F("Entering menu: "));
+    logInfo.println(menuPosition);
+
+    memcpy_P(&state, &table[menuPosition], sizeof(state));
+    if (state.enter) { state.enter(); }
+  }
+
+  if (menuDirty) {
+    menuDirty = false;
+    if (state.render) { state.render(); }
+  }
+}
+
+void menuGo(byte state) { menuNext = state; }
+
+void menuRedraw(void) { menuDirty = true; }
+
+void menuTouch(void) { menuLastAction = millis(); }
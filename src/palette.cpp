@@ -0,0 +1,89 @@
+#include "palette.h"
+
+#include "tables.h"
+
+byte     paletteCache[PALETTE_COLORS][3];
+uint16_t paletteLoad[PALETTE_COLORS];
+
+/*
+ * Color schemes, RGB, for the hour tens, hour ones, minute tens and minute ones
+ */
+
+const static byte PROGMEM schemes[PALETTE_SCHEMES][PALETTE_SCHEME_COLORS][3] = {
+  { { 255, 0, 0 },     { 0, 255, 0 },     { 0, 0, 255 },     { 139, 0, 139 } },    // Default
+  { { 0, 0, 255 },     { 255, 255, 0 },   { 139, 0, 139 },   { 0, 255, 0 } },      // TIX II
+  { { 13, 175, 186 },  { 0, 255, 0 },     { 154, 154, 50 },  { 255, 255, 0 } },    // Green/yellow
+  { { 255, 0, 0 },     { 255, 69, 0 },    { 255, 140, 0 },   { 255, 255, 0 } },    // Red/orange
+  { { 129, 13, 112 },  { 73, 29, 118 },   { 23, 46, 124 },   { 13, 175, 186 } },   // Purple/blue
+  { { 255, 0, 0 },     { 0, 255, 0 },     { 255, 0, 0 },     { 0, 255, 0 } },      // Christmas
+  { { 255, 255, 255 }, { 0, 0, 255 },     { 255, 255, 255 }, { 0, 0, 255 } },      // Hanukkah
+};
+
+const static byte PROGMEM dimWhite[3] = { 50, 50, 50 };
+const static byte PROGMEM white[3]    = { 255, 255, 255 };
+
+// Scheme color of each digit group, from the layout
+template <typename Seq>
+struct GroupColors;
+template <byte... Is>
+struct GroupColors<IndexSeq<Is...> > {
+  static const byte PROGMEM color[sizeof...(Is)];
+};
+template <byte... Is>
+const byte PROGMEM GroupColors<IndexSeq<Is...> >::color[sizeof...(Is)] = { groupColor(Is)... };
+
+typedef GroupColors<MakeIndexSeq<DIGIT_GROUPS>::type> Groups;
+
+constexpr bool colorsInScheme(byte group = 0) {
+  return group == DIGIT_GROUPS ||
+         (groupColor(group) < PALETTE_SCHEME_COLORS && colorsInScheme(group + 1));
+}
+static_assert(colorsInScheme(), "a digit group's color is not in the schemes");
+
+/*
+ * Brightness setting to PWM scale: the identity up to 50, then even steps of PWM^(1/2.6) from
+ * 50 to 250 (generated; see palette.h)
+ */
+
+const static byte PROGMEM levels[256] = {
+    0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,  15,
+   16,  17,  18,  19,  20,  21,  22,  23,  24,  25,  26,  27,  28,  29,  30,  31,
+   32,  33,  34,  35,  36,  37,  38,  39,  40,  41,  42,  43,  44,  45,  46,  47,
+   48,  49,  50,  51,  51,  52,  52,  53,  53,  54,  55,  55,  56,  56,  57,  58,
+   58,  59,  59,  60,  61,  61,  62,  63,  63,  64,  64,  65,  66,  66,  67,  68,
+   68,  69,  70,  71,  71,  72,  73,  73,  74,  75,  75,  76,  77,  78,  78,  79,
+   80,  81,  81,  82,  83,  84,  84,  85,  86,  87,  87,  88,  89,  90,  91,  91,
+   92,  93,  94,  95,  96,  96,  97,  98,  99, 100, 101, 101, 102, 103, 104, 105,
+  106, 107, 108, 109, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119, 120,
+  121, 122, 122, 123, 124, 125, 126, 127, 128, 129, 130, 131, 132, 133, 134, 135,
+  136, 138, 139, 140, 141, 142, 143, 144, 145, 146, 147, 148, 149, 150, 151, 153,
+  154, 155, 156, 157, 158, 159, 160, 162, 163, 164, 165, 166, 167, 169, 170, 171,
+  172, 173, 174, 176, 177, 178, 179, 181, 182, 183, 184, 185, 187, 188, 189, 191,
+  192, 193, 194, 196, 197, 198, 200, 201, 202, 203, 205, 206, 207, 209, 210, 211,
+  213, 214, 216, 217, 218, 220, 221, 222, 224, 225, 227, 228, 230, 231, 232, 234,
+  235, 237, 238, 240, 241, 243, 244, 246, 247, 249, 250, 252, 253, 255, 255, 255,
+};
+
+byte paletteLevel(byte brightness) { return pgm_read_byte(&levels[brightness]); }
+
+// Scale a PROGMEM RGB color into a cache entry, the way Adafruit_NeoPixel scales a pixel
+static void buildColor(byte color, const byte *rgb, uint16_t scale) {
+  const byte order = LAYOUT_COLOR_ORDER;
+  byte      *out   = paletteCache[color];
+  out[(order >> 4) & 0b11] = (pgm_read_byte(&rgb[0]) * scale) >> 8;
+  out[(order >> 2) & 0b11] = (pgm_read_byte(&rgb[1]) * scale) >> 8;
+  out[order & 0b11]        = (pgm_read_byte(&rgb[2]) * scale) >> 8;
+  paletteLoad[color]       = out[0] + out[1] + out[2];
+}
+
+void paletteBuild(byte scheme, byte brightness) {
+  uint16_t scale = (uint16_t)paletteLevel(brightness) + 1;
+
+  memset(paletteCache[PALETTE_OFF], 0, 3);
+  paletteLoad[PALETTE_OFF] = 0;
+  for (byte g = 0; g < DIGIT_GROUPS; g++) {
+    buildColor(PALETTE_DIGIT + g, schemes[scheme][pgm_read_byte(&Groups::color[g])], scale);
+  }
+  buildColor(PALETTE_DIM_WHITE, dimWhite, scale);
+  buildColor(PALETTE_WHITE, white, scale);
+}
@@ -0,0 +1,68 @@
+#include "pattern.h"
+
+#include "rng.h"
+
+/*
+ * Binomial coefficients C(n, k) for n, k <= PATTERN_MAX_LEDS, built at compile time
+ */
+
+constexpr unsigned int binomial(byte n, byte k) {
+  return (k > n) ? 0 : (k == 0 || k == n) ? 1 : binomial(n - 1, k - 1) + binomial(n - 1, k);
+}
+
+#define BINOMIAL_ROW(n)                                                                     \
+  {                                                                                         \
+    binomial(n, 0), binomial(n, 1), binomial(n, 2), binomial(n, 3), binomial(n, 4),         \
+        binomial(n, 5), binomial(n, 6), binomial(n, 7), binomial(n, 8), binomial(n, 9)      \
+  }
+
+static_assert(PATTERN_MAX_LEDS == 9, "binomial table rows are written out for 9 LEDs");
+static_assert(binomial(PATTERN_MAX_LEDS, PATTERN_MAX_LEDS / 2) <= 255,
+              "binomials must fit a byte");
+
+const static byte PROGMEM binomials[PATTERN_MAX_LEDS + 1][PATTERN_MAX_LEDS + 1] = {
+  BINOMIAL_ROW(0), BINOMIAL_ROW(1), BINOMIAL_ROW(2), BINOMIAL_ROW(3), BINOMIAL_ROW(4),
+  BINOMIAL_ROW(5), BINOMIAL_ROW(6), BINOMIAL_ROW(7), BINOMIAL_ROW(8), BINOMIAL_ROW(9),
+};
+
+static inline byte choose(byte n, byte k) { return pgm_read_byte(&binomials[n][k]); }
+
+/*
+ * The group's LEDs are relabelled so the previously lit ones come first. In colexicographic
+ * order the count-subsets of those first `lit` labels are exactly the ranks below
+ * C(lit, count), so drawing a rank from [C(lit, count), C(size, count)) and unranking it gives
+ * a uniform pick among the subsets that light at least one previously dark LED.
+ */
+uint16_t patternNext(byte size, byte count, uint16_t previous) {
+  if (count == 0) { return 0; }
+  if (count >= size) { return (1U << size) - 1; }
+
+  // Relabelling: order[j] is the group position behind label j
+  byte order[PATTERN_MAX_LEDS];
+  byte lit = 0;
+  for (byte i = 0; i < size; i++) {
+    if (previous & (1U << i)) { order[lit++] = i; }
+  }
+  byte dark = lit;
+  for (byte i = 0; i < size; i++) {
+    if (!(previous & (1U << i))) { order[dark++] = i; }
+  }
+
+  byte total    = choose(size, count);
+  byte excluded = choose(lit, count);
+  if (excluded == total) { excluded = 0; }   // everything was lit, no change is possible
+
+  byte rank = excluded + rngBelow(total - excluded);
+
+  // Colex unranking: pick the largest label c with C(c, k) <= rank for k = count..1. Labels
+  // only ever decrease, so this is at most size + count steps.
+  uint16_t pattern = 0;
+  byte     c       = size;
+  for (byte k = count; k > 0; k--) {
+    do { c--; } while (choose(c, k) > rank);
+    rank -= choose(c, k);
+    pattern |= 1U << order[c];
+  }
+
+  return pattern;
+}
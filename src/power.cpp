@@ -0,0 +1,39 @@
+#include "power.h"
+
+#include "frame.h"
+
+uint16_t powerMa       = 0;
+uint16_t powerDemandMa = 0;
+uint32_t powerLimited  = 0;
+
+// The largest channel sum within the budget
+#define POWER_BUDGET_LOAD                                                         \
+  ((POWER_BUDGET_MA - LAYOUT_PIXELS * (uint32_t)POWER_IDLE_UA / 1000) * 255UL / \
+   POWER_MA_PER_CHANNEL)
+
+static_assert(POWER_BUDGET_MA > LAYOUT_PIXELS * (uint32_t)POWER_IDLE_UA / 1000,
+              "the budget must cover the pixels' idle current");
+static_assert(LAYOUT_PIXELS * 3UL * 255 <= 0xFFFF, "a frame's channel sum must fit 16 bits");
+
+uint16_t powerEstimate(uint16_t load) {
+  return LAYOUT_PIXELS * (uint32_t)POWER_IDLE_UA / 1000 +
+         ((uint32_t)load * POWER_MA_PER_CHANNEL + 127) / 255;
+}
+
+void powerLimit(byte *pixels, uint16_t load) {
+  powerDemandMa = powerEstimate(load);
+  if (load <= POWER_BUDGET_LOAD) {
+    powerMa = powerDemandMa;
+    return;
+  }
+
+  // Rounded down, so the scaled frame is within the budget
+  uint16_t scale = (uint32_t)POWER_BUDGET_LOAD * 256 / load;
+  uint16_t fits  = 0;
+  for (byte i = 0; i < LAYOUT_PIXELS * 3; i++) {
+    pixels[i] = (pixels[i] * scale) >> 8;
+    fits += pixels[i];
+  }
+  powerMa = powerEstimate(fits);
+  powerLimited++;
+}
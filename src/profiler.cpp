@@ -0,0 +1,43 @@
+#include "profiler.h"
+
+#ifdef LOOP_PROFILER
+
+#include "histogram.h"
+
+static Histogram profile[PROFILER_STATES];
+
+// Names for the dump, indexed by menu position
+const char profileName0[] PROGMEM = "display";
+const char profileName1[] PROGMEM = "set hours";
+const char profileName2[] PROGMEM = "set minute tens";
+const char profileName3[] PROGMEM = "set minute ones";
+const char profileName4[] PROGMEM = "save time";
+const char profileName5[] PROGMEM = "interval chooser";
+const char profileName6[] PROGMEM = "save interval";
+const char profileName7[] PROGMEM = "color chooser";
+const char profileName8[] PROGMEM = "save color";
+const char profileName9[] PROGMEM = "splash";
+
+const char *const profileNames[PROFILER_STATES] PROGMEM = {
+  profileName0, profileName1, profileName2, profileName3, profileName4,
+  profileName5, profileName6, profileName7, profileName8, profileName9,
+};
+
+void profilerRecord(byte state, unsigned long us) {
+  if (state < PROFILER_STATES) { histogramRecord(profile[state], us); }
+}
+
+void profilerReset(void) { memset(profile, 0, sizeof(profile)); }
+
+void profilerDump(void) {
+  Serial.println(F("Loop profile (us): state, count, min, max, p99, buckets from <8 us"));
+
+  for (byte s = 0; s < PROFILER_STATES; s++) {
+    if (profile[s].count == 0) { continue; }
+
+    Serial.print((const __FlashStringHelper *)pgm_read_ptr(&profileNames[s]));
+    histogramPrint(profile[s]);
+  }
+}
+
+#endif
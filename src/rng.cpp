@@ -0,0 +1,91 @@
+#include "rng.h"
+
+static uint32_t      rngState        = 2463534242UL;   // any nonzero value; the seed is mixed in
+static volatile byte rngTimeoutsLeft = 0;              // watchdog timeouts still to sample
+
+static uint32_t rngStep(void) {
+  uint32_t x = rngState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  rngState = x;
+  return x;
+}
+
+uint32_t rngNext(void) {
+  RNG_DRAWN(false);
+  return rngStep();
+}
+
+byte rngBelow(byte bound) {
+  RNG_DRAWN(true);
+  return ((rngStep() >> 8) * bound) >> 24;
+}
+
+// Stir in entropy without charging draws or touching interrupts, for the watchdog interrupt
+static void rngStir(uint32_t entropy) {
+  rngState ^= entropy;
+  if (rngState == 0) { rngState = 2463534242UL; }   // the one state xorshift can't leave
+
+  // Spread the new bits over the whole state before the next draw
+  for (byte i = 0; i < 4; i++) { rngStep(); }
+}
+
+void rngMix(uint32_t entropy) {
+  // The watchdog interrupt may still be stirring its samples in. Draws aren't guarded: the
+  // first digits go up after the splash or a long click, long after its last timeout
+  noInterrupts();
+  rngStir(entropy);
+  interrupts();
+}
+
+void rngSeed(uint32_t seed) {
+  rngState = 0;
+  rngMix(seed);
+}
+
+void rngBegin(void) {
+  // Only the bottom bit or two of each read is noise; rotate them in a few bits apart
+  uint32_t adc = 0;
+  for (byte i = 0; i < RNG_ADC_READS; i++) {
+    adc = (adc << 5 | adc >> 27) ^ analogRead(RNG_ADC_PIN);
+  }
+  rngMix(adc);
+
+  // The watchdog jitter comes in the background, so loop() starts without waiting for it
+  rngTimeoutsLeft = RNG_JITTER_SAMPLES;
+  rngWatchdogStart();
+}
+
+bool rngTimeout(void) {
+  // The watchdog's RC oscillator drifts against the crystal, so Timer0's count at each timeout
+  // varies by a few LSBs; the low bits of micros() carry them
+  rngStir(micros());
+  return --rngTimeoutsLeft > 0;
+}
+
+#ifdef __AVR__
+
+#include <avr/interrupt.h>
+#include <avr/wdt.h>
+
+void rngWatchdogStart(void) {
+  // Interrupt-only mode at its shortest (16 ms) timeout
+  cli();
+  wdt_reset();
+  MCUSR &= ~_BV(WDRF);
+  WDTCSR = _BV(WDCE) | _BV(WDE);
+  WDTCSR = _BV(WDIE);
+  sei();
+}
+
+ISR(WDT_vect) {
+  if (rngTimeout()) { return; }
+
+  // Sampled enough: off again (interrupts are already held off in here)
+  wdt_reset();
+  WDTCSR = _BV(WDCE) | _BV(WDE);
+  WDTCSR = 0;
+}
+
+#endif
@@ -0,0 +1,57 @@
+#include "sched.h"
+
+unsigned int schedDutyCycle = 10000;
+
+static unsigned long schedDeadline    = 0;
+static volatile bool schedWoken       = false;
+static unsigned long schedWindowStart = 0;
+static unsigned long schedWindowSlept = 0;   // us asleep in the current window
+
+void schedAt(unsigned long ms) {
+  if ((long)(ms - schedDeadline) < 0) { schedDeadline = ms; }
+}
+
+unsigned long schedNext(void) { return schedDeadline; }
+
+void schedWake(void) { schedWoken = true; }
+
+void schedSleep(void) {
+  unsigned long start = micros();
+  while (!schedWoken && !Serial.available() && (long)(schedDeadline - millis()) > 0) {
+    schedIdle();
+  }
+  schedWoken = false;
+
+  unsigned long end = micros();
+  schedDeadline     = millis() + SCHED_MAX_SLEEP;
+
+  // Only the sleep is timed; the rest of the window was spent awake
+  schedWindowSlept += end - start;
+  unsigned long window = end - schedWindowStart;
+  if (window >= SCHED_DUTY_WINDOW) {
+    schedDutyCycle   = (window - schedWindowSlept) * 100 / (window / 100);
+    schedWindowStart = end;
+    schedWindowSlept = 0;
+  }
+}
+
+#ifdef __AVR__
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+void schedIdle(void) {
+  // Check and sleep with interrupts off: sei() lets one more instruction run, so an interrupt
+  // can't slip in between the check and the sleep and leave us waiting for the next one
+  cli();
+  if (!schedWoken) {
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+  }
+  sei();
+}
+
+#endif
@@ -0,0 +1,88 @@
+#include "settings.h"
+
+#include <EEPROM.h>
+
+#include "log.h"
+#include "store.h"
+
+static_assert(sizeof(Settings) <= STORE_PAYLOAD_MAX, "settings must fit a store record");
+
+Settings settings;
+
+/*
+ * Format history
+ *
+ * 0  Firmware from before the store: a struct at the start of the EEPROM, marked by its first
+ *    byte, with the update interval (uint32_t ms), the four digit colors (uint32_t each, never
+ *    read back), brightness and color scheme; 23 bytes as the AVR packs it.
+ * 1  Settings as above.
+ *
+ * Each migration turns a record of one version into the next, in place.
+ */
+
+#define LEGACY_FLAG B10110011
+#define LEGACY_SIZE 23
+#define LEGACY_INTERVAL 1
+#define LEGACY_BRIGHTNESS 21
+#define LEGACY_COLOR_SCHEME 22
+
+#define RECORD_MAX LEGACY_SIZE   // the largest version
+
+typedef bool (*Migration)(byte *record, byte &length);
+
+static bool migrateV0(byte *record, byte &length) {
+  if (length < LEGACY_SIZE) { return false; }
+
+  // The old interval was a uint32_t, but only ever one of the menu's three values
+  Settings v1;
+  v1.updateInterval = record[LEGACY_INTERVAL] | (record[LEGACY_INTERVAL + 1] << 8);
+  v1.brightness     = record[LEGACY_BRIGHTNESS];
+  v1.colorScheme    = record[LEGACY_COLOR_SCHEME];
+
+  memcpy(record, &v1, sizeof(v1));
+  length = sizeof(v1);
+  return true;
+}
+
+static const Migration migrations[SETTINGS_VERSION] = { migrateV0 };
+
+bool settingsLoad(void) {
+  byte record[RECORD_MAX];
+  byte version, length;
+
+  bool found = storeLoad(record, sizeof(record), version, length);
+  storeAttach(&settings, sizeof(settings), SETTINGS_VERSION);
+
+  if (!found) {
+    if (EEPROM.read(0) != LEGACY_FLAG) { return false; }
+    EEPROM.get(0, record);
+    version = 0;
+    length  = LEGACY_SIZE;
+  }
+
+  if (version > SETTINGS_VERSION) {
+    logWarn.print(F("Settings are from a newer firmware, version "));
+    logWarn.println(version);
+    return false;
+  }
+
+  byte saved = version;
+  while (version < SETTINGS_VERSION) {
+    if (!migrations[version](record, length)) { return false; }
+    version++;
+  }
+  if (length < sizeof(settings)) { return false; }
+  memcpy(&settings, record, sizeof(settings));
+
+  if (saved != SETTINGS_VERSION) {
+    logInfo.print(F("Settings migrated from version "));
+    logInfo.println(saved);
+    settingsChanged();
+    settingsFlush();
+  }
+  return true;
+}
+
+void settingsChanged(void) { storeChanged(); }
+
+void settingsFlush(void) { storeFlush(); }
@@ -0,0 +1,144 @@
+#include "store.h"
+
+#include <EEPROM.h>
+
+#include "crc.h"
+#include "sched.h"
+#include "telemetry.h"
+
+#define STORE_SLOTS ((E2END + 1) / STORE_SLOT_SIZE)   // 256 or more on a 4 KB EEPROM
+#define STORE_VERSION 2   // offsets within a slot
+#define STORE_LENGTH 3
+#define STORE_PAYLOAD 4
+
+unsigned long storeBytesWritten = 0;
+unsigned long storeBlockedUs    = 0;
+
+static const byte   *storePayload   = NULL;
+static byte          storeLength    = 0;
+static byte          storeVersion   = 0;
+static int           storeNewest    = -1;
+static uint16_t      storeSequence  = 0;
+static bool          storeDirty     = false;
+static unsigned long storeChangedAt = 0;
+
+static int slotAddress(uint16_t slot) { return slot * STORE_SLOT_SIZE; }
+
+static uint16_t readWord(int address) {
+  return EEPROM.read(address) | (EEPROM.read(address + 1) << 8);
+}
+
+// Is there a complete record in the slot?
+static bool slotValid(int address) {
+  if (readWord(address) == 0xFFFF) { return false; }
+  byte length = EEPROM.read(address + STORE_LENGTH);
+  if (length > STORE_PAYLOAD_MAX) { return false; }
+
+  uint16_t crc = CRC16_INIT;
+  for (byte i = 0; i < STORE_PAYLOAD + length; i++) {
+    crc = crc16Update(crc, EEPROM.read(address + i));
+  }
+  return crc == readWord(address + STORE_PAYLOAD + length);
+}
+
+// Program a cell only if it changes, counting the cost
+static void storeUpdate(int address, byte value) {
+  if (EEPROM.read(address) == value) { return; }
+
+  unsigned long start = micros();
+  EEPROM.write(address, value);
+  storeBlockedUs += micros() - start;
+  storeBytesWritten++;
+}
+
+bool storeLoad(void *payload, byte size, byte &version, byte &length) {
+  storeNewest = -1;
+
+  for (uint16_t slot = 0; slot < STORE_SLOTS; slot++) {
+    int address = slotAddress(slot);
+    if (!slotValid(address)) { continue; }
+
+    // Sequence numbers wrap; newer means ahead by less than half the range
+    uint16_t sequence = readWord(address);
+    if (storeNewest < 0 || (int16_t)(sequence - storeSequence) > 0) {
+      storeNewest   = slot;
+      storeSequence = sequence;
+    }
+  }
+
+  if (storeNewest < 0) { return false; }
+
+  int address = slotAddress(storeNewest);
+  version     = EEPROM.read(address + STORE_VERSION);
+  length      = EEPROM.read(address + STORE_LENGTH);
+  for (byte i = 0; i < length && i < size; i++) {
+    ((byte *)payload)[i] = EEPROM.read(address + STORE_PAYLOAD + i);
+  }
+  return true;
+}
+
+void storeAttach(const void *payload, byte length, byte version) {
+  storePayload = (const byte *)payload;
+  storeLength  = length > STORE_PAYLOAD_MAX ? STORE_PAYLOAD_MAX : length;
+  storeVersion = version;
+}
+
+void storeChanged(void) {
+  storeDirty     = true;
+  storeChangedAt = millis();
+}
+
+void storePoll(void) {
+  if (!storeDirty) { return; }
+  if ((unsigned long)(millis() - storeChangedAt) >= STORE_COMMIT_DELAY) {
+    storeFlush();
+  } else {
+    schedAt(storeChangedAt + STORE_COMMIT_DELAY);
+  }
+}
+
+// Does the newest record already hold the attached payload?
+static bool storeUnchanged(void) {
+  if (storeNewest < 0) { return false; }
+
+  int address = slotAddress(storeNewest);
+  if (EEPROM.read(address + STORE_VERSION) != storeVersion ||
+      EEPROM.read(address + STORE_LENGTH) != storeLength) {
+    return false;
+  }
+  for (byte i = 0; i < storeLength; i++) {
+    if (EEPROM.read(address + STORE_PAYLOAD + i) != storePayload[i]) { return false; }
+  }
+  return true;
+}
+
+void storeFlush(void) {
+  if (!storeDirty || !storePayload) { return; }
+  storeDirty = false;
+  if (storeUnchanged()) { return; }
+
+  if (++storeSequence == 0xFFFF) { storeSequence = 0; }
+  uint16_t slot    = (storeNewest < 0) ? 0 : (storeNewest + 1) % STORE_SLOTS;
+  int      address = slotAddress(slot);
+
+  // Everything but the CRC first, then the CRC that makes the record valid
+  byte header[STORE_PAYLOAD] = { (byte)storeSequence, (byte)(storeSequence >> 8), storeVersion,
+                                 storeLength };
+
+  uint16_t crc = CRC16_INIT;
+  for (byte i = 0; i < STORE_PAYLOAD; i++) {
+    storeUpdate(address + i, header[i]);
+    crc = crc16Update(crc, header[i]);
+  }
+  for (byte i = 0; i < storeLength; i++) {
+    storeUpdate(address + STORE_PAYLOAD + i, storePayload[i]);
+    crc = crc16Update(crc, storePayload[i]);
+  }
+  storeUpdate(address + STORE_PAYLOAD + storeLength, crc);
+  storeUpdate(address + STORE_PAYLOAD + storeLength + 1, crc >> 8);
+
+  storeNewest = slot;
+  TELEMETRY_COUNT(eepromWrites);
+}
+
+int storeSlot(void) { return storeNewest; }
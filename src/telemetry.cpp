@@ -0,0 +1,82 @@
+#include "telemetry.h"
+
+#ifdef TELEMETRY
+
+#include "bcd.h"
+#include "crc.h"
+#include "frame.h"
+#include "log.h"
+#include "power.h"
+#include "sched.h"
+
+TelemetryCounters telemetry;
+
+static byte          telemetrySequence    = 0;
+static unsigned long telemetryLastSend    = 0;
+static uint32_t      telemetryLastShows   = 0;
+static uint32_t      telemetryLastLimited = 0;
+
+void telemetryButtons(int set, int up, int down) {
+  if (set) { telemetry.clicks[0]++; }
+  if (up) { telemetry.clicks[1]++; }
+  if (down) { telemetry.clicks[2]++; }
+}
+
+void telemetryResync(byte oldH, byte oldM, byte oldS, byte newH, byte newM, byte newS) {
+  long delta = ((long)bcdToBin(newH) - bcdToBin(oldH)) * 3600 +
+               ((int)bcdToBin(newM) - bcdToBin(oldM)) * 60 + ((int)bcdToBin(newS) - bcdToBin(oldS));
+
+  // Across midnight the short way round is the real jump
+  if (delta >= 43200) {
+    delta -= 86400;
+  } else if (delta < -43200) {
+    delta += 86400;
+  }
+
+  // The frame field is 16 bits (only the first sync after power-up jumps this far)
+  telemetry.rtcDelta = constrain(delta, -32767L, 32767L);
+  telemetry.resyncs++;
+}
+
+static byte *put16(byte *p, uint16_t v) {
+  *p++ = v;
+  *p++ = v >> 8;
+  return p;
+}
+
+void telemetryPoll(byte hour, byte minute, byte second) {
+  if ((unsigned long)(millis() - telemetryLastSend) < TELEMETRY_INTERVAL) {
+    schedAt(telemetryLastSend + TELEMETRY_INTERVAL);
+    return;
+  }
+  telemetryLastSend = millis();
+
+  uint32_t shows = frameShowsIssued - telemetryLastShows;
+  telemetryLastShows = frameShowsIssued;
+  uint32_t limited = powerLimited - telemetryLastLimited;
+  telemetryLastLimited = powerLimited;
+
+  byte  frame[TELEMETRY_FRAME_SIZE];
+  byte *p = frame;
+  *p++    = TELEMETRY_SYNC;
+  *p++    = telemetrySequence++;
+  p       = put16(p, telemetry.loops);
+  p       = put16(p, telemetry.loops >> 16);
+  *p++    = hour;
+  *p++    = minute;
+  *p++    = second;
+  p       = put16(p, telemetry.rtcDelta);
+  *p++    = telemetry.resyncs;
+  p       = put16(p, shows > 0xFFFF ? 0xFFFF : shows);
+  *p++    = telemetry.eepromWrites;
+  for (byte i = 0; i < 3; i++) { *p++ = telemetry.clicks[i]; }
+  p    = put16(p, powerMa);
+  p    = put16(p, powerDemandMa);
+  *p++ = limited > 0xFF ? 0xFF : limited;
+  *p = crc8(frame, TELEMETRY_FRAME_SIZE - 1);
+
+  logWriteRaw(frame, TELEMETRY_FRAME_SIZE);
+  memset(&telemetry, 0, sizeof(telemetry));
+}
+
+#endif
@@ -0,0 +1,116 @@
+#include "twi.h"
+
+byte twiTransfer(byte address, const byte *tx, byte txLength, byte *rx, byte rxLength) {
+  while (!twiStart(address, tx, txLength, rx, rxLength)) {}
+  byte status;
+  while ((status = twiStatus()) == TWI_BUSY) {}
+  return status;
+}
+
+#ifdef __AVR__
+
+#include <avr/interrupt.h>
+#include <util/twi.h>
+
+/*
+ * State shared with the interrupt handler
+ */
+
+static volatile byte  twiState = TWI_DONE;
+static byte           twiAddress;
+static const byte    *twiTx;
+static byte           twiTxLength;
+static byte          *twiRx;
+static byte           twiRxLength;
+static volatile byte  twiIndex;
+
+#define TWCR_RUN (_BV(TWEN) | _BV(TWIE) | _BV(TWINT))   // clear the flag, keep going
+
+void twiBegin(uint32_t clockHz) {
+  // SCL = F_CPU / (16 + 2 * TWBR), prescaler 1
+  TWSR = 0;
+  TWBR = ((F_CPU / clockHz) - 16) / 2;
+
+  digitalWrite(SDA, HIGH);
+  digitalWrite(SCL, HIGH);
+  TWCR = _BV(TWEN);
+}
+
+byte twiStatus(void) { return twiState; }
+
+bool twiStart(byte address, const byte *tx, byte txLength, byte *rx, byte rxLength) {
+  // The previous STOP is still going out until TWSTO clears
+  if (twiState == TWI_BUSY || (TWCR & _BV(TWSTO))) { return false; }
+
+  twiAddress  = address;
+  twiTx       = tx;
+  twiTxLength = txLength;
+  twiRx       = rx;
+  twiRxLength = rxLength;
+  twiIndex    = 0;
+  twiState    = TWI_BUSY;
+
+  TWCR = TWCR_RUN | _BV(TWSTA);
+  return true;
+}
+
+static void twiStop(byte state) {
+  TWCR     = _BV(TWEN) | _BV(TWINT) | _BV(TWSTO);
+  twiState = state;
+}
+
+// Read phase acknowledges every byte but the last
+static void twiAckNext(void) {
+  TWCR = (twiIndex + 1 < twiRxLength) ? (TWCR_RUN | _BV(TWEA)) : TWCR_RUN;
+}
+
+ISR(TWI_vect) {
+  switch (TW_STATUS) {
+    case TW_START:
+    case TW_REP_START:
+      // Write phase first, if there is one (an empty transaction is a write, to probe)
+      TWDR = (twiAddress << 1) | (twiTxLength || !twiRxLength ? TW_WRITE : TW_READ);
+      TWCR = TWCR_RUN;
+      break;
+
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+      if (twiIndex < twiTxLength) {
+        TWDR = twiTx[twiIndex++];
+        TWCR = TWCR_RUN;
+      } else if (twiRxLength) {
+        twiTxLength = 0;   // sent; the repeated start goes on to the read
+        twiIndex    = 0;
+        TWCR        = TWCR_RUN | _BV(TWSTA);
+      } else {
+        twiStop(TWI_DONE);
+      }
+      break;
+
+    case TW_MR_SLA_ACK:
+      twiAckNext();
+      break;
+
+    case TW_MR_DATA_ACK:
+      twiRx[twiIndex++] = TWDR;
+      twiAckNext();
+      break;
+
+    case TW_MR_DATA_NACK:
+      twiRx[twiIndex++] = TWDR;
+      twiStop(TWI_DONE);
+      break;
+
+    case TW_MT_ARB_LOST:   // same code as TW_MR_ARB_LOST
+      // Another master has the bus; let go without a STOP
+      TWCR     = _BV(TWEN) | _BV(TWINT);
+      twiState = TWI_ERROR;
+      break;
+
+    default:   // NACKs and bus errors
+      twiStop(TWI_ERROR);
+      break;
+  }
+}
+
+#endif